@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "AssetIO.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// State behind a stream over a mapped file. SDL_RWFromConstMem can't be used because the mapping has to
+	// be released when the stream is closed.
+	struct mappedStream
+	{
+		MappedFile file;
+		size_t pos = 0;
+	};
+
+	mappedStream *streamOf(SDL_RWops *context)
+	{
+		return static_cast<mappedStream *>(context->hidden.unknown.data1);
+	}
+
+	Sint64 SDLCALL mappedSize(SDL_RWops *context)
+	{
+		return static_cast<Sint64>(streamOf(context)->file.size());
+	}
+
+	Sint64 SDLCALL mappedSeek(SDL_RWops *context, Sint64 offset, int whence)
+	{
+		mappedStream *stream = streamOf(context);
+		Sint64 base = 0;
+		switch (whence)
+		{
+		case RW_SEEK_SET:
+			base = 0;
+			break;
+		case RW_SEEK_CUR:
+			base = static_cast<Sint64>(stream->pos);
+			break;
+		case RW_SEEK_END:
+			base = static_cast<Sint64>(stream->file.size());
+			break;
+		default:
+			return SDL_SetError("Unknown value for 'whence'");
+		}
+		const Sint64 target = base + offset;
+		if (target < 0 || target > static_cast<Sint64>(stream->file.size()))
+		{
+			return SDL_SetError("Seek outside of mapped file");
+		}
+		stream->pos = static_cast<size_t>(target);
+		return target;
+	}
+
+	size_t SDLCALL mappedRead(SDL_RWops *context, void *ptr, size_t size, size_t maxnum)
+	{
+		mappedStream *stream = streamOf(context);
+		if (size == 0)
+		{
+			return 0;
+		}
+		const size_t available = (stream->file.size() - stream->pos) / size;
+		const size_t count = maxnum < available ? maxnum : available;
+		std::memcpy(ptr, stream->file.data() + stream->pos, count * size);
+		stream->pos += count * size;
+		return count;
+	}
+
+	size_t SDLCALL mappedWrite(SDL_RWops *, const void *, size_t, size_t)
+	{
+		SDL_SetError("Mapped assets are read-only");
+		return 0;
+	}
+
+	int SDLCALL mappedClose(SDL_RWops *context)
+	{
+		delete streamOf(context);
+		SDL_FreeRW(context);
+		return 0;
+	}
+}
+
+void AssetIO::registerMemory(const std::string &name, const void *data, size_t size, const decodedImage *decoded)
+{
+	memoryBlock block = { data, size, { 0, 0, 0, SDL_PIXELFORMAT_UNKNOWN } };
+	if (decoded != nullptr)
+	{
+		block.decoded = *decoded;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	index[normalizeName(name)] = block;
+}
+
+void AssetIO::unregister(const std::string &name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	index.erase(normalizeName(name));
+}
+
+SDL_RWops *AssetIO::open(const std::string &path) const
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto found = index.find(normalizeName(path));
+		if (found != index.end())
+		{
+			return SDL_RWFromConstMem(found->second.data, static_cast<int>(found->second.size));
+		}
+	}
+	return mapFile(path);
+}
+
+SDL_Surface *AssetIO::openDecoded(const std::string &path) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto found = index.find(normalizeName(path));
+	if (found == index.end() || found->second.decoded.pixelFormat == SDL_PIXELFORMAT_UNKNOWN)
+	{
+		return NULL;
+	}
+	// SDL never writes through a surface it didn't allocate unless asked to, so casting away const is safe here.
+	const decodedImage &image = found->second.decoded;
+	return SDL_CreateRGBSurfaceWithFormatFrom(const_cast<void *>(found->second.data), image.width, image.height,
+		SDL_BITSPERPIXEL(image.pixelFormat), image.pitch, image.pixelFormat);
+}
+
+SDL_RWops *AssetIO::mapFile(const std::string &path)
+{
+	mappedStream *stream = new mappedStream();
+	if (!stream->file.open(path))
+	{
+		delete stream;
+		SDL_SetError("Couldn't map %s", path.c_str());
+		return NULL;
+	}
+
+	SDL_RWops *context = SDL_AllocRW();
+	if (context == NULL)
+	{
+		delete stream;
+		return NULL;
+	}
+	context->size = mappedSize;
+	context->seek = mappedSeek;
+	context->read = mappedRead;
+	context->write = mappedWrite;
+	context->close = mappedClose;
+	context->type = SDL_RWOPS_UNKNOWN;
+	context->hidden.unknown.data1 = stream;
+	return context;
+}
+
+std::string AssetIO::normalizeName(const std::string &path)
+{
+	std::string name = path;
+	std::replace(name.begin(), name.end(), '\\', '/');
+	// Collapse the doubled separator directory_iterator leaves behind when the directory already ends in one.
+	for (size_t pos = name.find("//"); pos != std::string::npos; pos = name.find("//"))
+	{
+		name.erase(pos, 1);
+	}
+	return name;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Opens assets without going through stdio, from one index that serves both loose files and packed archives.
+// Blocks of memory that are already resident (the members of a mapped PuzzlePack, an embedded asset) are registered
+// under their asset name and served straight from memory; every other name is memory-mapped from disk.
+// Everything here may be called from any thread.
+class AssetIO
+{
+public:
+	// How the pixels of a registered block are laid out, for blocks that hold an image that is already decoded.
+	struct decodedImage
+	{
+		int width;
+		int height;
+		int pitch;
+		Uint32 pixelFormat;
+	};
+
+	// Serves name from [data, data + size) from now on. The memory must outlive every stream and surface opened on it.
+	// Pass decoded if the block holds pixels rather than an image file, so openDecoded() can hand them out.
+	void registerMemory(const std::string &name, const void *data, size_t size, const decodedImage *decoded = nullptr);
+
+	// Serves name from disk again, e.g. because the file changed after the block was registered.
+	void unregister(const std::string &name);
+
+	// Returns a stream over the registered block for path, or over the mapped file if none is registered.
+	// Returns NULL if neither exists. Pass the stream to an SDL loader with freesrc set, or SDL_RWclose it.
+	SDL_RWops *open(const std::string &path) const;
+
+	// Returns a surface over the registered pixels if path was registered as a decoded image, otherwise NULL.
+	// Free it as usual; the pixels stay owned by whoever registered them.
+	SDL_Surface *openDecoded(const std::string &path) const;
+
+	// Maps a file and returns a stream that unmaps it when closed.
+	static SDL_RWops *mapFile(const std::string &path);
+
+	// Asset names always use '/', whatever the platform's path separator.
+	static std::string normalizeName(const std::string &path);
+
+private:
+	struct memoryBlock
+	{
+		const void *data;
+		size_t size;
+		decodedImage decoded; // pixelFormat is SDL_PIXELFORMAT_UNKNOWN for an image file.
+	};
+
+	mutable std::mutex mutex;
+	std::map<std::string, memoryBlock> index;
+};
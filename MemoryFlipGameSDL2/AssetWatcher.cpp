@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "AssetWatcher.h"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+
+AssetWatcher::AssetWatcher()
+{
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+AssetWatcher::~AssetWatcher()
+{
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+}
+
+bool AssetWatcher::watch(const std::string &dir)
+{
+	if (fd < 0)
+	{
+		return false;
+	}
+	// Editors either rewrite a file in place (CLOSE_WRITE) or write a temporary and rename it over (MOVED_TO).
+	const int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (wd < 0)
+	{
+		return false;
+	}
+	watchedDirs[wd] = dir;
+	return true;
+}
+
+void AssetWatcher::poll(std::vector<std::string> &changed)
+{
+	if (fd < 0)
+	{
+		return;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+	for (;;)
+	{
+		const ssize_t length = read(fd, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			return; // EAGAIN: nothing more pending.
+		}
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+			auto dir = watchedDirs.find(event->wd);
+			if (event->len > 0 && dir != watchedDirs.end())
+			{
+				changed.push_back(dir->second + event->name);
+			}
+			offset += sizeof(inotify_event) + event->len;
+		}
+	}
+}
+
+#else
+
+AssetWatcher::AssetWatcher()
+{
+}
+
+AssetWatcher::~AssetWatcher()
+{
+}
+
+bool AssetWatcher::watch(const std::string &)
+{
+	return false;
+}
+
+void AssetWatcher::poll(std::vector<std::string> &)
+{
+}
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Notices when files in the asset directories are rewritten, so sheets can be reloaded while the game runs.
+// Uses inotify on Linux. Elsewhere watch() fails and poll() never reports anything.
+class AssetWatcher
+{
+public:
+	AssetWatcher();
+	~AssetWatcher();
+
+	AssetWatcher(const AssetWatcher &) = delete;
+	AssetWatcher &operator=(const AssetWatcher &) = delete;
+
+	// Starts watching a directory (non-recursively). dir should end in '/'.
+	bool watch(const std::string &dir);
+
+	// Appends the paths of files that finished being written since the last call. Never blocks.
+	void poll(std::vector<std::string> &changed);
+
+private:
+	int fd = -1;
+	std::map<int, std::string> watchedDirs; // inotify watch descriptor to directory.
+};
@@ -0,0 +1,39 @@
+#include "BoardGenerator.h"
+#include "Rng.h"
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+BoardGenerator::BoardGenerator(int piecesTotal)
+	: total(piecesTotal)
+{
+	assert(piecesTotal % 2 == 0);
+}
+
+void BoardGenerator::deal(std::uint64_t seed, std::uint16_t *pairIds) const
+{
+	// See the note at the top of MemoryFlipGameSDL2.cpp for why the id travels with the src tile.
+	const int sizeHalf = total / 2;
+	for (int rectI = 0; rectI < sizeHalf; rectI++)
+	{
+		pairIds[rectI] = static_cast<std::uint16_t>(rectI);
+		pairIds[rectI + sizeHalf] = static_cast<std::uint16_t>(rectI);
+	}
+
+	// Fisher-Yates with our own bounded draw; std::shuffle's draws are up to the standard library.
+	Rng rng(seed);
+	for (int i = total - 1; i > 0; i--)
+	{
+		const int j = static_cast<int>(rng.bounded(static_cast<std::uint32_t>(i + 1)));
+		std::swap(pairIds[i], pairIds[j]);
+	}
+}
+
+void BoardGenerator::dealBatch(std::uint64_t firstSeed, int count, std::vector<std::uint16_t> &out) const
+{
+	out.resize(static_cast<size_t>(count) * total);
+	for (int boardI = 0; boardI < count; boardI++)
+	{
+		deal(firstSeed + boardI, out.data() + static_cast<size_t>(boardI) * total);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Deals boards: two of every pair id, shuffled. A board is a pure function of its seed, so the same seed gives the
+// same board on every platform, and a board someone reports can be dealt again from the seed in the log.
+class BoardGenerator
+{
+public:
+	explicit BoardGenerator(int piecesTotal);
+
+	// Writes piecesTotal pair ids for the board dealt from seed.
+	void deal(std::uint64_t seed, std::uint16_t *pairIds) const;
+
+	// Deals count boards, for seeds firstSeed, firstSeed + 1, ..., back to back into out (piecesTotal ids each).
+	void dealBatch(std::uint64_t firstSeed, int count, std::vector<std::uint16_t> &out) const;
+
+	int piecesTotal() const { return total; }
+
+private:
+	int total;
+};
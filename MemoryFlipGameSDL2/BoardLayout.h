@@ -0,0 +1,42 @@
+#pragma once
+
+// Where the pieces of a board sit on screen: a grid of square tiles with a fixed gap between them.
+// Tile positions and hit testing are pure arithmetic on the origin and pitch, so both are O(1) however big the board gets.
+struct BoardLayout
+{
+	static const int noTile = -1;
+
+	int originX;
+	int originY;
+	int pieceSize;
+	int gap;
+	int cols;
+	int rows;
+
+	constexpr int pitch() const { return pieceSize + gap; }
+	constexpr int tilesTotal() const { return cols * rows; }
+	constexpr int width() const { return cols * pitch() - gap; }
+	constexpr int height() const { return rows * pitch() - gap; }
+
+	constexpr int tileX(int index) const { return originX + (index % cols) * pitch(); }
+	constexpr int tileY(int index) const { return originY + (index / cols) * pitch(); }
+
+	// Returns the index of the tile under the point, or noTile if the point is off the board or in a gap.
+	// Tiles cover [x, x + pieceSize), so neighbouring tiles never share an edge pixel.
+	constexpr int tileAt(int x, int y) const
+	{
+		const int localX = x - originX;
+		const int localY = y - originY;
+		if (localX < 0 || localY < 0)
+		{
+			return noTile;
+		}
+		const int col = localX / pitch();
+		const int row = localY / pitch();
+		if (col >= cols || row >= rows || localX % pitch() >= pieceSize || localY % pitch() >= pieceSize)
+		{
+			return noTile;
+		}
+		return row * cols + col;
+	}
+};
@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "BoardPool.h"
+#include "Trace.h"
+#include <utility>
+
+BoardPool::BoardPool(int piecesTotal, std::uint64_t firstSeed)
+	: generator(piecesTotal), nextSeed(firstSeed)
+{
+	worker = std::thread(&BoardPool::workerLoop, this);
+}
+
+BoardPool::~BoardPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void BoardPool::take(dealtBoard &board)
+{
+	const std::uint64_t wanted = nextSeed.load(std::memory_order_relaxed);
+	unsigned h = head.load(std::memory_order_relaxed);
+	const unsigned t = tail.load(std::memory_order_acquire);
+	bool found = false;
+	// Boards for seeds before wanted were dealt here while the worker was still busy with them; they are dropped.
+	while (h != t && !found)
+	{
+		dealtBoard &slot = slots[h % capacity];
+		found = slot.seed == wanted;
+		if (found)
+		{
+			std::swap(board.pairIds, slot.pairIds);
+		}
+		h++;
+	}
+	head.store(h, std::memory_order_release);
+
+	if (!found)
+	{
+		board.pairIds.resize(generator.piecesTotal());
+		generator.deal(wanted, board.pairIds.data());
+	}
+	board.seed = wanted;
+	nextSeed.store(wanted + 1, std::memory_order_relaxed);
+
+	// Taking the lock only orders the wake-up against the worker's check; it is never held for longer than that check.
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+	}
+	wake.notify_one();
+}
+
+void BoardPool::workerLoop()
+{
+	Trace::nameThread("board pool");
+	std::uint64_t seed = nextSeed.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		const unsigned t = tail.load(std::memory_order_relaxed);
+		{
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wake.wait(lock, [&] { return stopping || t - head.load(std::memory_order_acquire) < static_cast<unsigned>(capacity); });
+			if (stopping)
+			{
+				return;
+			}
+		}
+
+		// Don't deal boards that take() has already dealt for itself.
+		const std::uint64_t wanted = nextSeed.load(std::memory_order_relaxed);
+		if (seed < wanted)
+		{
+			seed = wanted;
+		}
+
+		TraceSpan span("deal board");
+		dealtBoard &slot = slots[t % capacity];
+		slot.seed = seed;
+		slot.pairIds.resize(generator.piecesTotal());
+		generator.deal(seed, slot.pairIds.data());
+		seed++;
+		tail.store(t + 1, std::memory_order_release);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "BoardGenerator.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Deals the next few boards ahead of time on a worker thread, so starting a new board never has to shuffle on the main thread.
+// Boards are dealt for consecutive seeds and handed over in that order through a single-producer, single-consumer ring:
+// taking a board is a couple of atomic loads and a vector swap, and never waits for the worker.
+// If the worker has fallen behind, take() deals the board itself, so the sequence of boards is the same either way.
+class BoardPool
+{
+public:
+	struct dealtBoard
+	{
+		std::uint64_t seed = 0;
+		std::vector<std::uint16_t> pairIds;
+	};
+
+	static const int capacity = 4; // Boards kept ready.
+
+	// The first board taken is dealt from firstSeed, the next from firstSeed + 1, and so on.
+	BoardPool(int piecesTotal, std::uint64_t firstSeed);
+	~BoardPool();
+
+	BoardPool(const BoardPool &) = delete;
+	BoardPool &operator=(const BoardPool &) = delete;
+
+	// Fills board with the next board in seed order. Only one thread may take boards.
+	// The vector board held before is handed to the worker to deal into, so steady-state play doesn't allocate.
+	void take(dealtBoard &board);
+
+private:
+	void workerLoop();
+
+	BoardGenerator generator;
+	dealtBoard slots[capacity];
+	std::atomic<unsigned> head{ 0 }; // Next slot to take. Written only by the taking thread.
+	std::atomic<unsigned> tail{ 0 }; // Next slot to deal into. Written only by the worker.
+	std::atomic<std::uint64_t> nextSeed; // Seed of the board the next take() returns.
+	std::atomic<bool> stopping{ false };
+
+	// Only used to put the worker to sleep while the ring is full; the hand-over itself doesn't lock.
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+	std::thread worker;
+};
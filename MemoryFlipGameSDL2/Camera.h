@@ -0,0 +1,89 @@
+#pragma once
+
+#include "BoardLayout.h"
+#include <cmath>
+
+// Which part of the board the window shows. The board lives in world pixels (the coordinates BoardLayout works in),
+// and the camera maps them to the window with an offset and a zoom factor.
+// The visible tiles fall straight out of the grid arithmetic, so finding them costs the same however big the board is.
+struct Camera
+{
+	// Tiles [col0, col1) x [row0, row1).
+	struct tileRange
+	{
+		int col0;
+		int row0;
+		int col1;
+		int row1;
+	};
+
+	// Zooming out is capped so that the number of tiles on screen, and with it the cost of a frame, stays bounded.
+	static constexpr float minZoom = 0.25f;
+	static constexpr float maxZoom = 4.0f;
+
+	float x = 0.0f; // World position shown at the window's top-left corner.
+	float y = 0.0f;
+	float zoom = 1.0f;
+	int viewWidth = 0;
+	int viewHeight = 0;
+
+	// Both edges of a tile are rounded separately, so neighbouring tiles never overlap or leave a seam when zoomed.
+	int toScreenX(int worldX) const { return static_cast<int>(std::floor((worldX - x) * zoom + 0.5f)); }
+	int toScreenY(int worldY) const { return static_cast<int>(std::floor((worldY - y) * zoom + 0.5f)); }
+	int toWorldX(int screenX) const { return static_cast<int>(std::floor(x + screenX / zoom)); }
+	int toWorldY(int screenY) const { return static_cast<int>(std::floor(y + screenY / zoom)); }
+
+	// Moves the view by a drag of dx, dy window pixels, so the board follows the pointer.
+	void pan(int dx, int dy)
+	{
+		x -= dx / zoom;
+		y -= dy / zoom;
+	}
+
+	// Zooms by factor, keeping the world point under the given window position in place.
+	void zoomAt(int screenX, int screenY, float factor)
+	{
+		const float worldX = x + screenX / zoom;
+		const float worldY = y + screenY / zoom;
+		zoom *= factor;
+		zoom = zoom < minZoom ? minZoom : (zoom > maxZoom ? maxZoom : zoom);
+		x = worldX - screenX / zoom;
+		y = worldY - screenY / zoom;
+	}
+
+	// Keeps the view over a world of the given size. A world narrower than the view is centred in it.
+	void clampTo(int worldWidth, int worldHeight)
+	{
+		x = clampAxis(x, static_cast<float>(worldWidth), viewWidth / zoom);
+		y = clampAxis(y, static_cast<float>(worldHeight), viewHeight / zoom);
+	}
+
+	tileRange visibleTiles(const BoardLayout &layout) const
+	{
+		const float left = (x - layout.originX) / layout.pitch();
+		const float top = (y - layout.originY) / layout.pitch();
+		const float right = (x + viewWidth / zoom - layout.originX) / layout.pitch();
+		const float bottom = (y + viewHeight / zoom - layout.originY) / layout.pitch();
+		tileRange range;
+		range.col0 = clampIndex(static_cast<int>(std::floor(left)), layout.cols);
+		range.row0 = clampIndex(static_cast<int>(std::floor(top)), layout.rows);
+		range.col1 = clampIndex(static_cast<int>(std::floor(right)) + 1, layout.cols);
+		range.row1 = clampIndex(static_cast<int>(std::floor(bottom)) + 1, layout.rows);
+		return range;
+	}
+
+private:
+	static float clampAxis(float pos, float world, float view)
+	{
+		if (world <= view)
+		{
+			return (world - view) / 2;
+		}
+		return pos < 0 ? 0 : (pos > world - view ? world - view : pos);
+	}
+
+	static int clampIndex(int i, int count)
+	{
+		return i < 0 ? 0 : (i > count ? count : i);
+	}
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+// One rectangle of a frame: either dst filled with color, or src copied from an atlas page into dst, tinted by color.
+struct DrawCommand
+{
+	int tile = -1; // The board tile this draws, or -1 for anything else (e.g. the stats overlay).
+	int page = -1; // Atlas page to copy from, or -1 for a fill.
+	SDL_Rect src = { 0, 0, 0, 0 };
+	SDL_Rect dst = { 0, 0, 0, 0 };
+	SDL_Color color = { 255, 255, 255, 255 }; // Fills with alpha below 255 are blended.
+
+	static DrawCommand fill(int tile, const SDL_Rect &dst, SDL_Color color)
+	{
+		DrawCommand command;
+		command.tile = tile;
+		command.dst = dst;
+		command.color = color;
+		return command;
+	}
+
+	static DrawCommand copy(int tile, int page, const SDL_Rect &src, const SDL_Rect &dst, SDL_Color tint)
+	{
+		DrawCommand command;
+		command.tile = tile;
+		command.page = page;
+		command.src = src;
+		command.dst = dst;
+		command.color = tint;
+		return command;
+	}
+};
+
+// Everything the main thread needs to put one frame on screen. It only holds rectangles and atlas page numbers,
+// so the game state it was built from can move on while it is drawn.
+struct DrawList
+{
+	bool clearBoard = false; // Clear the board target to clearColor before drawing board.
+	SDL_Color clearColor = { 0, 0, 0, 255 };
+	std::vector<DrawCommand> board; // Drawn, in order, onto the persistent board target.
+	std::vector<DrawCommand> overlay; // Drawn over the board target on screen.
+	std::string title; // New window title, or empty to leave it.
+
+	// Empties the list but keeps its capacity, so steady-state frames don't allocate.
+	void reset()
+	{
+		clearBoard = false;
+		board.clear();
+		overlay.clear();
+		title.clear();
+	}
+};
@@ -0,0 +1,31 @@
+#include "pch.h"
+#include "DrawListBuffer.h"
+
+bool DrawListBuffer::submit()
+{
+	int idle = -1;
+	if (!published.compare_exchange_strong(idle, writing, std::memory_order_acq_rel))
+	{
+		return false;
+	}
+	// The other list was published last time, and the main thread has just released it.
+	writing ^= 1;
+	lists[writing].reset();
+
+	SDL_Event wake;
+	SDL_zero(wake);
+	wake.type = wakeEvent;
+	SDL_PushEvent(&wake);
+	return true;
+}
+
+const DrawList *DrawListBuffer::acquire() const
+{
+	const int listI = published.load(std::memory_order_acquire);
+	return listI >= 0 ? &lists[listI] : NULL;
+}
+
+void DrawListBuffer::release()
+{
+	published.store(-1, std::memory_order_release);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "DrawList.h"
+#include <SDL.h>
+#include <atomic>
+
+// Hands DrawLists from the game thread, which builds them, to the main thread, which draws them, through a
+// lock-free double buffer. The game thread fills back() and submit() publishes it with a single compare-and-swap,
+// once the main thread has released the list before it. Until then the back list stays put, so the next frame's
+// commands are added to it and nothing drawn is lost. Neither side ever waits for the other.
+class DrawListBuffer
+{
+public:
+	// Publishing a list pushes an SDL event of type wakeEvent, so the main thread's SDL_WaitEvent wakes up for it.
+	explicit DrawListBuffer(Uint32 wakeEvent) : wakeEvent(wakeEvent) {}
+
+	DrawListBuffer(const DrawListBuffer &) = delete;
+	DrawListBuffer &operator=(const DrawListBuffer &) = delete;
+
+	// Game thread: the list the next submit() publishes.
+	DrawList &back() { return lists[writing]; }
+
+	// Game thread: publishes back() and starts a fresh one, unless the last list hasn't been released yet.
+	// Returns whether it did.
+	bool submit();
+
+	// Main thread: the published list, or NULL if there is none. It stays valid and unchanged until release().
+	const DrawList *acquire() const;
+	void release();
+
+private:
+	Uint32 wakeEvent;
+	DrawList lists[2];
+	int writing = 0; // The back list. Only the game thread reads or writes it.
+	std::atomic<int> published{ -1 }; // The list handed to the main thread, or -1 once it has been released.
+};
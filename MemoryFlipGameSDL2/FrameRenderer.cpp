@@ -0,0 +1,88 @@
+#include "pch.h"
+#include "FrameRenderer.h"
+#include "RendererSelector.h"
+#include "Trace.h"
+
+FrameRenderer::FrameRenderer(SDL_Window *window, const std::string &rendererCachePath, int targetWidth, int targetHeight)
+{
+	const int driverI = RendererSelector::choose(window, rendererCachePath);
+	renderer.reset(SDL_CreateRenderer(window, driverI, SDL_RENDERER_TARGETTEXTURE));
+	if (!renderer)
+	{
+		SDL_Log("FrameRenderer: could not create a renderer: %s", SDL_GetError());
+	}
+	boardTex.reset(SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, targetWidth, targetHeight));
+	if (renderer && !boardTex)
+	{
+		SDL_Log("FrameRenderer: could not create the board target: %s", SDL_GetError());
+	}
+	SDL_SetTextureBlendMode(boardTex.get(), SDL_BLENDMODE_NONE); // Opaque, so presenting it is a straight copy.
+	textureAtlas.reset(new TextureAtlas(renderer.get()));
+}
+
+FrameRenderer::~FrameRenderer()
+{
+	// Textures have to go before the renderer that made them.
+	textureAtlas.reset();
+	boardTex.reset();
+}
+
+double FrameRenderer::takeRenderMs()
+{
+	return renderTicks.exchange(0, std::memory_order_relaxed) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+void FrameRenderer::draw(const DrawList &list)
+{
+	TraceSpan span("draw list");
+	const Uint64 begin = SDL_GetPerformanceCounter();
+	textureAtlas->flushUploads();
+
+	SDL_SetRenderTarget(renderer.get(), boardTex.get());
+	if (list.clearBoard)
+	{
+		SDL_SetRenderDrawColor(renderer.get(), list.clearColor.r, list.clearColor.g, list.clearColor.b, list.clearColor.a);
+		SDL_RenderClear(renderer.get());
+	}
+	for (const DrawCommand &command : list.board)
+	{
+		draw(command);
+	}
+	SDL_SetRenderTarget(renderer.get(), NULL);
+
+	SDL_RenderCopy(renderer.get(), boardTex.get(), NULL, NULL);
+	for (const DrawCommand &command : list.overlay)
+	{
+		draw(command);
+	}
+
+	{
+		TraceSpan presentSpan("SDL_RenderPresent");
+		SDL_RenderPresent(renderer.get());
+	}
+	renderTicks.fetch_add(SDL_GetPerformanceCounter() - begin, std::memory_order_relaxed);
+}
+
+void FrameRenderer::draw(const DrawCommand &command)
+{
+	const SDL_Color &color = command.color;
+	if (command.page < 0)
+	{
+		SDL_SetRenderDrawBlendMode(renderer.get(), color.a == 255 ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+		SDL_SetRenderDrawColor(renderer.get(), color.r, color.g, color.b, color.a);
+		SDL_RenderFillRect(renderer.get(), &command.dst);
+		return;
+	}
+
+	SDL_Texture *texture = textureAtlas->texture(command.page);
+	const bool tinted = color.r != 255 || color.g != 255 || color.b != 255;
+	if (tinted)
+	{
+		SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+	}
+	SDL_RenderCopy(renderer.get(), texture, &command.src, &command.dst);
+	if (tinted)
+	{
+		SDL_SetTextureColorMod(texture, 255, 255, 255);
+	}
+}
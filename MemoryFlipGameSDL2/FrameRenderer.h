@@ -0,0 +1,45 @@
+#pragma once
+
+#include "DrawList.h"
+#include "SdlDestructors.h"
+#include "TextureAtlas.h"
+#include <SDL.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+// Owns the renderer, the persistent board target and the atlas textures, and turns DrawLists into pixels on screen.
+// SDL's render API must be called from the main thread (SDL_render.h), which also owns the window and pumps its
+// events: the renderer's own event watch runs inside SDL_PumpEvents, and the OpenGL driver may recreate the window.
+// So this lives on the main thread, and the game logic that builds the lists runs on a thread of its own instead.
+class FrameRenderer
+{
+public:
+	// Creates the renderer for window (benchmarking the drivers the first time, see RendererSelector),
+	// a targetWidth x targetHeight board target and the atlas.
+	FrameRenderer(SDL_Window *window, const std::string &rendererCachePath, int targetWidth, int targetHeight);
+	~FrameRenderer();
+
+	FrameRenderer(const FrameRenderer &) = delete;
+	FrameRenderer &operator=(const FrameRenderer &) = delete;
+
+	// False if the renderer or the board target could not be created; the reason has been logged.
+	bool ready() const { return renderer && boardTex; }
+
+	// Images may be packed on another thread; they are uploaded here before the next list is drawn.
+	TextureAtlas &atlas() { return *textureAtlas; }
+
+	// Uploads what the atlas has queued, draws the list and presents it.
+	void draw(const DrawList &list);
+
+	// Milliseconds spent in draw() since the last call. Safe to call from any thread.
+	double takeRenderMs();
+
+private:
+	void draw(const DrawCommand &command);
+
+	std::unique_ptr<SDL_Renderer, sdlDestructorRenderer> renderer;
+	std::unique_ptr<SDL_Texture, sdlDestructorTexture> boardTex;
+	std::unique_ptr<TextureAtlas> textureAtlas;
+	std::atomic<Uint64> renderTicks{ 0 };
+};
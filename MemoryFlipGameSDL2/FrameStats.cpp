@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "FrameStats.h"
+#include <algorithm>
+#include <fstream>
+
+FrameStats::FrameStats()
+	: frequency(SDL_GetPerformanceFrequency())
+{
+	for (auto &phaseSamples : samples)
+	{
+		phaseSamples.assign(windowFrames, 0.0f);
+	}
+}
+
+void FrameStats::beginFrame()
+{
+	frameStart = SDL_GetPerformanceCounter();
+	lastMark = frameStart;
+	std::fill(current, current + phaseCount, 0.0f);
+}
+
+void FrameStats::endPhase(Phase phase)
+{
+	const Uint64 now = SDL_GetPerformanceCounter();
+	current[static_cast<int>(phase)] += static_cast<float>(ticksToMs(now - lastMark));
+	lastMark = now;
+}
+
+void FrameStats::addTime(Phase phase, double ms)
+{
+	current[static_cast<int>(phase)] += static_cast<float>(ms);
+}
+
+void FrameStats::endFrame()
+{
+	current[static_cast<int>(Phase::FRAME)] = static_cast<float>(ticksToMs(SDL_GetPerformanceCounter() - frameStart));
+	for (int phaseI = 0; phaseI < phaseCount; phaseI++)
+	{
+		samples[phaseI][next] = current[phaseI];
+	}
+	next = (next + 1) % windowFrames;
+	filled = std::min(filled + 1, windowFrames);
+}
+
+FrameStats::summary FrameStats::summarize(Phase phase) const
+{
+	summary result;
+	if (filled == 0)
+	{
+		return result;
+	}
+
+	// The window is small, so a partial sort of a copy is cheaper than keeping buckets up to date every frame.
+	const std::vector<float> &phaseSamples = samples[static_cast<int>(phase)];
+	std::vector<float> sorted(phaseSamples.begin(), phaseSamples.begin() + filled);
+	auto at = [&](double fraction)
+	{
+		auto nth = sorted.begin() + static_cast<int>(fraction * (filled - 1));
+		std::nth_element(sorted.begin(), nth, sorted.end());
+		return static_cast<double>(*nth);
+	};
+	result.p50 = at(0.50);
+	result.p99 = at(0.99);
+	result.max = *std::max_element(sorted.begin(), sorted.end());
+	return result;
+}
+
+bool FrameStats::writeCsv(const std::string &path) const
+{
+	std::ofstream out(path, std::ios::trunc);
+	out << "frame";
+	for (int phaseI = 0; phaseI < phaseCount; phaseI++)
+	{
+		out << ',' << phaseName(static_cast<Phase>(phaseI)) << "_ms";
+	}
+	out << '\n';
+
+	const int oldest = filled < windowFrames ? 0 : next;
+	for (int frameI = 0; frameI < filled; frameI++)
+	{
+		const int sampleI = (oldest + frameI) % windowFrames;
+		out << frameI;
+		for (int phaseI = 0; phaseI < phaseCount; phaseI++)
+		{
+			out << ',' << samples[phaseI][sampleI];
+		}
+		out << '\n';
+	}
+	return static_cast<bool>(out);
+}
+
+const char *FrameStats::phaseName(Phase phase)
+{
+	switch (phase)
+	{
+	case Phase::INPUT:
+		return "input";
+	case Phase::LOGIC:
+		return "logic";
+	case Phase::RENDER:
+		return "render";
+	case Phase::PRESENT:
+		return "present";
+	case Phase::FRAME:
+		return "frame";
+	}
+	return "";
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+// Times the phases of each frame with the high-resolution performance counter and keeps the last windowFrames frames,
+// so the p50/p99/max of every phase can be read back at any point, or the raw frames written out as CSV.
+// Phases are timed back to back: endPhase() charges the time since the previous mark to the phase it names,
+// and a phase a frame skipped (e.g. nothing to render) counts as zero for that frame.
+// Work done elsewhere on the frame's behalf, like the main thread presenting it, is added with addTime() and isn't
+// part of FRAME, which is only the time between beginFrame() and endFrame().
+class FrameStats
+{
+public:
+	enum class Phase { INPUT, LOGIC, RENDER, PRESENT, FRAME };
+	static const int phaseCount = 5;
+	static const int windowFrames = 600; // Ten seconds at 60 fps.
+
+	struct summary
+	{
+		double p50 = 0.0; // All in ms.
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	FrameStats();
+
+	void beginFrame();
+	void endPhase(Phase phase);
+	void addTime(Phase phase, double ms);
+	void endFrame();
+
+	// Over the frames currently in the window.
+	summary summarize(Phase phase) const;
+	int frames() const { return filled; }
+
+	// One row per frame in the window, oldest first.
+	bool writeCsv(const std::string &path) const;
+
+	static const char *phaseName(Phase phase);
+
+private:
+	double ticksToMs(Uint64 ticks) const { return ticks * 1000.0 / frequency; }
+
+	Uint64 frequency;
+	Uint64 frameStart = 0;
+	Uint64 lastMark = 0;
+	float current[phaseCount] = {};
+	std::vector<float> samples[phaseCount]; // Rolling window of each phase, in ms.
+	int next = 0;
+	int filled = 0;
+};
@@ -0,0 +1,84 @@
+#include "GameSession.h"
+#include <cassert>
+
+GameSession::GameSession(int piecesTotal, std::uint64_t seed)
+	: generator(piecesTotal), pairIds(piecesTotal)
+{
+	assert(piecesTotal / 2 <= maxPairs);
+	flipped.resize(piecesTotal);
+	solvedPieces.resize(piecesTotal);
+	changed.resize(piecesTotal);
+	reset(seed);
+}
+
+void GameSession::reset(std::uint64_t seed)
+{
+	generator.deal(seed, pairIds.data());
+	hideAll(seed);
+}
+
+void GameSession::reset(std::uint64_t seed, std::vector<std::uint16_t> &dealtPairIds)
+{
+	assert(dealtPairIds.size() == pairIds.size());
+	pairIds.swap(dealtPairIds);
+	hideAll(seed);
+}
+
+void GameSession::hideAll(std::uint64_t seed)
+{
+	boardSeed = seed;
+	flipped.clear();
+	solvedPieces.clear();
+	changed.setAll();
+	solvedCount = 0;
+	flippedCount = 0;
+}
+
+bool GameSession::flip(int index)
+{
+	if (flippedCount >= maxFlipped || visState(index) != VisState::HIDDEN)
+	{
+		return false;
+	}
+	flippedIndices[flippedCount] = index;
+	flipped.set(index);
+	changed.set(index);
+	flippedCount++;
+	return true;
+}
+
+bool GameSession::resolvePending() const
+{
+	return flippedCount >= maxFlipped;
+}
+
+GameSession::ResolveResult GameSession::resolve()
+{
+	if (!resolvePending())
+	{
+		return ResolveResult::NONE;
+	}
+
+	flippedCount = 0;
+	flipped.reset(flippedIndices[0]);
+	flipped.reset(flippedIndices[1]);
+	changed.set(flippedIndices[0]);
+	changed.set(flippedIndices[1]);
+	if (pairIds[flippedIndices[0]] == pairIds[flippedIndices[1]])
+	{
+		solvedPieces.set(flippedIndices[0]);
+		solvedPieces.set(flippedIndices[1]);
+		solvedCount += 2;
+		return ResolveResult::MATCH;
+	}
+	return ResolveResult::MISMATCH;
+}
+
+GameSession::VisState GameSession::visState(int index) const
+{
+	if (solvedPieces.test(index))
+	{
+		return VisState::SOLVED;
+	}
+	return flipped.test(index) ? VisState::FLIPPED : VisState::HIDDEN;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BoardGenerator.h"
+#include "TileMask.h"
+#include <cstdint>
+#include <vector>
+
+// The rules of one memory board: flipping pieces, resolving a flipped pair, and knowing when the board is solved.
+// Nothing in here knows about SDL, so a session can be driven by the game window or by a headless simulation.
+// The front-end is responsible for turning clicks into piece indices and for drawing whatever state it reads back.
+class GameSession
+{
+public:
+	enum class VisState : std::uint8_t { HIDDEN, FLIPPED, SOLVED };
+	enum class ResolveResult { NONE, MATCH, MISMATCH };
+
+	static const int maxFlipped = 2; // The maximum number of "pieces" that can be in the flipped up state at the same time.
+	static const int maxPairs = UINT16_MAX + 1; // Pair ids are 16 bit.
+
+	// The board is dealt from seed; the same seed always gives the same board.
+	GameSession(int piecesTotal, std::uint64_t seed);
+
+	// Hides every piece and deals the board for seed. Pair ids are the src tile indices, so they never collide.
+	void reset(std::uint64_t seed);
+
+	// The same, for a board already dealt for seed elsewhere (e.g. by a BoardPool). Its ids are swapped in,
+	// and dealtPairIds gets the previous board's storage back.
+	void reset(std::uint64_t seed, std::vector<std::uint16_t> &dealtPairIds);
+
+	std::uint64_t seed() const { return boardSeed; }
+
+	// Flips the piece at index if it is hidden and there is room for another flipped piece.
+	// Returns true if the piece was flipped.
+	bool flip(int index);
+
+	// True once maxFlipped pieces are face up and waiting to be compared.
+	bool resolvePending() const;
+
+	// Compares the flipped pieces, marking them SOLVED on a match or turning them back over on a mismatch.
+	ResolveResult resolve();
+
+	bool solved() const { return solvedCount == piecesTotal(); }
+	int remainingPairs() const { return (piecesTotal() - solvedCount) / 2; }
+
+	// Pair identity. Both pieces of a pair share it, so a match check is a single compare.
+	// The picture it shows is sheet tile pairId % tileCount, with tint (pairId / tileCount) % tint count once the sheet runs out.
+	std::uint16_t pairId(int index) const { return pairIds[index]; }
+	VisState visState(int index) const;
+	int piecesTotal() const { return static_cast<int>(pairIds.size()); }
+
+	// Pieces whose state changed since the last clearChanged(), so a renderer only has to redraw those.
+	const TileMask &changedMask() const { return changed; }
+	void clearChanged() { changed.clear(); }
+
+private:
+	void hideAll(std::uint64_t seed);
+
+	BoardGenerator generator;
+	std::uint64_t boardSeed = 0;
+	std::vector<std::uint16_t> pairIds;
+	TileMask flipped; // State is kept as two bit planes; a piece in neither is HIDDEN.
+	TileMask solvedPieces;
+	TileMask changed;
+	int solvedCount = 0;
+	int flippedCount = 0;
+	int flippedIndices[maxFlipped] = {};
+};
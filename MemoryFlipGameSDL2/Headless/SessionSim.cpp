@@ -0,0 +1,206 @@
+// Plays boards headlessly against GameSession, with no SDL and no window, as fast as the rules allow.
+// Every board is played by a player with perfect memory, and checked along the way:
+// the deal must be a pure function of the seed, every pair id must appear exactly twice, and the board must end solved.
+// Before that, fixed seeds are checked against known Pcg32 outputs and a known deal, so a build whose boards differ from
+// every other platform's fails here, and dealBatch() is checked against dealing the same seeds one at a time.
+// Usage: SessionSim [games] [pieces] [first seed]. Exits with status 1 on the first board that breaks a rule.
+
+#include "../BoardGenerator.h"
+#include "../GameSession.h"
+#include "../Rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	struct gameResult
+	{
+		bool ok = false;
+		int turns = 0;
+	};
+
+	bool fail(std::uint64_t seed, const char *what)
+	{
+		std::printf("seed %llu: %s\n", static_cast<unsigned long long>(seed), what);
+		return false;
+	}
+
+	bool checkDeal(const GameSession &session, const GameSession &again)
+	{
+		std::vector<int> counts(session.piecesTotal() / 2, 0);
+		for (int pieceI = 0; pieceI < session.piecesTotal(); pieceI++)
+		{
+			if (session.pairId(pieceI) != again.pairId(pieceI))
+			{
+				return fail(session.seed(), "the same seed dealt two different boards");
+			}
+			if (session.pairId(pieceI) >= counts.size() || ++counts[session.pairId(pieceI)] > 2)
+			{
+				return fail(session.seed(), "a pair id is out of range or dealt more than twice");
+			}
+		}
+		return true;
+	}
+
+	// Values every platform must produce. Changing Pcg32 or the shuffle changes them, and every logged seed with them.
+	bool checkGolden()
+	{
+		static const std::uint32_t pcgSeed42[] = { 0xD11DD51Fu, 0xA9B04C45u, 0xB5D97AA9u, 0xA9EAB6CEu, 0xF63FD201u, 0x9D8FEFEBu };
+		static const std::uint32_t boundedSeed7[] = { 3, 3, 1, 7, 6, 0 }; // bounded(10)
+		static const std::uint16_t dealSeed42[] = { 2, 0, 1, 5, 2, 4, 3, 7, 7, 4, 6, 3, 0, 6, 1, 5 }; // 16 pieces
+
+		Pcg32 rng(42);
+		for (std::uint32_t expected : pcgSeed42)
+		{
+			if (rng.next() != expected)
+			{
+				return fail(42, "Pcg32 does not produce the reference sequence");
+			}
+		}
+		Pcg32 bounded(7);
+		for (std::uint32_t expected : boundedSeed7)
+		{
+			if (bounded.bounded(10) != expected)
+			{
+				return fail(7, "Pcg32::bounded does not produce the reference sequence");
+			}
+		}
+		std::uint16_t dealt[16];
+		BoardGenerator(16).deal(42, dealt);
+		if (!std::equal(dealt, dealt + 16, dealSeed42))
+		{
+			return fail(42, "BoardGenerator does not deal the reference board");
+		}
+		return true;
+	}
+
+	// The bulk path must deal exactly what dealing each seed on its own does.
+	bool checkBatch(int pieces, std::uint64_t firstSeed, int count)
+	{
+		const BoardGenerator generator(pieces);
+		std::vector<std::uint16_t> batch;
+		generator.dealBatch(firstSeed, count, batch);
+		std::vector<std::uint16_t> single(pieces);
+		for (int boardI = 0; boardI < count; boardI++)
+		{
+			generator.deal(firstSeed + boardI, single.data());
+			if (!std::equal(single.begin(), single.end(), batch.begin() + static_cast<size_t>(boardI) * pieces))
+			{
+				return fail(firstSeed + boardI, "dealBatch() dealt a different board than deal()");
+			}
+		}
+		return true;
+	}
+
+	// Turns over unseen pieces in order, remembering where each pair id was seen, and takes every pair it knows.
+	gameResult play(GameSession &session)
+	{
+		gameResult result;
+		const int pieces = session.piecesTotal();
+		std::vector<int> seenAt(pieces / 2, -1);
+		std::vector<int> knownPairs; // Both pieces seen but not yet taken, two entries per pair.
+		int cursor = 0; // Pieces before it have all been seen.
+		auto nextUnseen = [&]() { return cursor < pieces ? cursor++ : -1; };
+
+		while (!session.solved())
+		{
+			int first = -1;
+			int second = -1;
+			if (!knownPairs.empty())
+			{
+				second = knownPairs.back();
+				knownPairs.pop_back();
+				first = knownPairs.back();
+				knownPairs.pop_back();
+			}
+			else
+			{
+				first = nextUnseen();
+				const int firstPair = session.pairId(first);
+				if (seenAt[firstPair] >= 0)
+				{
+					second = seenAt[firstPair];
+				}
+				else
+				{
+					seenAt[firstPair] = first;
+					second = nextUnseen();
+					const int secondPair = session.pairId(second);
+					if (secondPair != firstPair)
+					{
+						if (seenAt[secondPair] >= 0)
+						{
+							knownPairs.push_back(seenAt[secondPair]);
+							knownPairs.push_back(second);
+						}
+						else
+						{
+							seenAt[secondPair] = second;
+						}
+					}
+				}
+			}
+
+			if (first < 0 || second < 0 || !session.flip(first) || !session.flip(second) || !session.resolvePending())
+			{
+				fail(session.seed(), "a hidden piece could not be flipped");
+				return result;
+			}
+			const bool pair = session.pairId(first) == session.pairId(second);
+			const GameSession::ResolveResult resolved = session.resolve();
+			if (resolved != (pair ? GameSession::ResolveResult::MATCH : GameSession::ResolveResult::MISMATCH))
+			{
+				fail(session.seed(), "resolve() disagreed with the pair ids");
+				return result;
+			}
+			result.turns++;
+		}
+		result.ok = session.remainingPairs() == 0;
+		return result;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const int games = argc >= 2 ? std::atoi(argv[1]) : 100000;
+	const int pieces = argc >= 3 ? std::atoi(argv[2]) : 100;
+	const std::uint64_t firstSeed = argc >= 4 ? std::strtoull(argv[3], NULL, 0) : 1;
+	if (games <= 0 || pieces <= 0 || pieces % 2 != 0 || pieces / 2 > GameSession::maxPairs)
+	{
+		std::printf("usage: SessionSim [games] [pieces: even, at most %d] [first seed]\n", GameSession::maxPairs * 2);
+		return 2;
+	}
+
+	if (!checkGolden() || !checkBatch(pieces, firstSeed, std::min(games, 64)))
+	{
+		return 1;
+	}
+
+	GameSession session(pieces, firstSeed);
+	GameSession again(pieces, firstSeed);
+	long long turns = 0;
+	const auto begin = std::chrono::steady_clock::now();
+	for (int gameI = 0; gameI < games; gameI++)
+	{
+		const std::uint64_t seed = firstSeed + gameI;
+		session.reset(seed);
+		again.reset(seed);
+		if (!checkDeal(session, again))
+		{
+			return 1;
+		}
+		const gameResult result = play(session);
+		if (!result.ok)
+		{
+			return 1;
+		}
+		turns += result.turns;
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::printf("%d games of %d pieces solved, %.1f turns per game, %.0f games/s\n",
+		games, pieces, static_cast<double>(turns) / games, games / seconds);
+	return 0;
+}
@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "InputQueue.h"
+#include <chrono>
+
+void InputQueue::gather()
+{
+	const Uint64 begin = SDL_GetPerformanceCounter();
+	pending.clear();
+	int motionIndex = -1; // Where this tick's POINTER_MOVE sits in pending, once there is one.
+	int panIndex = -1; // Likewise for this tick's PAN.
+
+	SDL_Event sdlEvent;
+	for (int handled = 0; handled < maxEventsPerTick && SDL_PollEvent(&sdlEvent); handled++)
+	{
+		switch (sdlEvent.type)
+		{
+		case SDL_QUIT:
+			push(GameCommand::Type::QUIT, sdlEvent.quit.timestamp);
+			break;
+		case SDL_WINDOWEVENT:
+			if (sdlEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
+			{
+				push(GameCommand::Type::REPAINT, sdlEvent.window.timestamp);
+			}
+			break;
+		case SDL_RENDER_TARGETS_RESET:
+		case SDL_RENDER_DEVICE_RESET:
+			push(GameCommand::Type::TARGETS_RESET, sdlEvent.common.timestamp);
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+			if (sdlEvent.button.button == SDL_BUTTON_LEFT)
+			{
+				push(GameCommand::Type::CLICK, sdlEvent.button.timestamp, sdlEvent.button.x, sdlEvent.button.y);
+				// Motion after the click must not be merged into motion from before it.
+				motionIndex = -1;
+				panIndex = -1;
+			}
+			break;
+		case SDL_MOUSEWHEEL:
+			if (sdlEvent.wheel.y != 0)
+			{
+				int x = 0;
+				int y = 0;
+				SDL_GetMouseState(&x, &y);
+				push(GameCommand::Type::ZOOM, sdlEvent.wheel.timestamp, x, y);
+				pending.back().dy = sdlEvent.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -sdlEvent.wheel.y : sdlEvent.wheel.y;
+			}
+			break;
+		case SDL_KEYDOWN:
+		{
+			int dx = 0;
+			int dy = 0;
+			switch (sdlEvent.key.keysym.sym)
+			{
+			case SDLK_LEFT: dx = keyPanStep; break;
+			case SDLK_RIGHT: dx = -keyPanStep; break;
+			case SDLK_UP: dy = keyPanStep; break;
+			case SDLK_DOWN: dy = -keyPanStep; break;
+			case SDLK_F2:
+			case SDLK_n:
+				push(GameCommand::Type::NEW_GAME, sdlEvent.key.timestamp);
+				break;
+			case SDLK_F3:
+				push(GameCommand::Type::TOGGLE_STATS, sdlEvent.key.timestamp);
+				break;
+			case SDLK_F4:
+				push(GameCommand::Type::DUMP_STATS, sdlEvent.key.timestamp);
+				break;
+			}
+			if (dx != 0 || dy != 0)
+			{
+				push(GameCommand::Type::PAN, sdlEvent.key.timestamp);
+				pending.back().dx = dx;
+				pending.back().dy = dy;
+				panIndex = -1;
+			}
+			break;
+		}
+		case SDL_MOUSEMOTION:
+			if (sdlEvent.motion.state & (SDL_BUTTON_RMASK | SDL_BUTTON_MMASK))
+			{
+				if (panIndex < 0)
+				{
+					panIndex = static_cast<int>(pending.size());
+					push(GameCommand::Type::PAN, sdlEvent.motion.timestamp);
+				}
+				GameCommand &pan = pending[panIndex];
+				pan.timestamp = sdlEvent.motion.timestamp;
+				pan.dx += sdlEvent.motion.xrel;
+				pan.dy += sdlEvent.motion.yrel;
+				break;
+			}
+			if (motionIndex < 0)
+			{
+				motionIndex = static_cast<int>(pending.size());
+				push(GameCommand::Type::POINTER_MOVE, sdlEvent.motion.timestamp);
+			}
+			{
+				GameCommand &motion = pending[motionIndex];
+				motion.timestamp = sdlEvent.motion.timestamp;
+				motion.x = sdlEvent.motion.x;
+				motion.y = sdlEvent.motion.y;
+				motion.dx += sdlEvent.motion.xrel;
+				motion.dy += sdlEvent.motion.yrel;
+			}
+			break;
+		}
+	}
+	gatherTicks.fetch_add(SDL_GetPerformanceCounter() - begin, std::memory_order_relaxed);
+}
+
+double InputQueue::takeGatherMs()
+{
+	return gatherTicks.exchange(0, std::memory_order_relaxed) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+void InputQueue::push(GameCommand::Type type, Uint32 timestamp, int x, int y)
+{
+	GameCommand cmd;
+	cmd.type = type;
+	cmd.timestamp = timestamp;
+	cmd.x = x;
+	cmd.y = y;
+	pending.push_back(cmd);
+}
+
+void CommandMailbox::post(const std::vector<GameCommand> &commands)
+{
+	if (commands.empty())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued.insert(queued.end(), commands.begin(), commands.end());
+	}
+	posted.notify_one();
+}
+
+void CommandMailbox::wait(Uint32 timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	posted.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return !queued.empty(); });
+}
+
+void CommandMailbox::take(std::vector<GameCommand> &out)
+{
+	out.clear();
+	std::lock_guard<std::mutex> lock(mutex);
+	out.swap(queued);
+}
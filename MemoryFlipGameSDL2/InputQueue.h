@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// A single thing the player (or the window system) asked the game to do, in the order SDL delivered it.
+struct GameCommand
+{
+	enum class Type { QUIT, NEW_GAME, CLICK, POINTER_MOVE, PAN, ZOOM, REPAINT, TARGETS_RESET, TOGGLE_STATS, DUMP_STATS };
+	Type type;
+	Uint32 timestamp; // SDL event timestamp, in ms since SDL_Init.
+	int x = 0; // Window coordinates for CLICK, POINTER_MOVE and ZOOM.
+	int y = 0;
+	int dx = 0; // Accumulated relative motion for POINTER_MOVE and PAN, in window pixels.
+	int dy = 0; // For ZOOM, the wheel steps: positive zooms in.
+};
+
+// Drains the SDL event queue once per tick and turns what it finds into GameCommands.
+// Mouse motion is coalesced into at most one POINTER_MOVE per tick (or one PAN while dragging with the right or
+// middle button), so a flood of motion events can't push a click back by more than one tick.
+// Events the game doesn't care about are dropped here.
+class InputQueue
+{
+public:
+	// Upper bound on events handled per tick; anything past it waits for the next tick rather than stalling this one.
+	static const int maxEventsPerTick = 1024;
+
+	// How far one press of an arrow key pans the board, in window pixels.
+	static const int keyPanStep = 40;
+
+	// Replaces the previous tick's commands with everything currently pending.
+	void gather();
+
+	const std::vector<GameCommand> &commands() const { return pending; }
+
+	// Milliseconds spent in gather() since the last call. Safe to call from any thread.
+	double takeGatherMs();
+
+private:
+	void push(GameCommand::Type type, Uint32 timestamp, int x = 0, int y = 0);
+
+	std::vector<GameCommand> pending;
+	std::atomic<Uint64> gatherTicks{ 0 };
+};
+
+// Carries commands from the main thread, which has to pump SDL's events, to the game thread.
+// Bursts are small and arrive at most once per event, so a mutex is plenty here.
+class CommandMailbox
+{
+public:
+	// Main thread: queues commands for the game thread and wakes it.
+	void post(const std::vector<GameCommand> &commands);
+
+	// Game thread: blocks for up to timeoutMs until something has been posted.
+	void wait(Uint32 timeoutMs);
+
+	// Game thread: replaces out with everything posted since the last take().
+	void take(std::vector<GameCommand> &out);
+
+private:
+	std::mutex mutex;
+	std::condition_variable posted;
+	std::vector<GameCommand> queued;
+};
@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (fileMapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	void *view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
+	{
+		CloseHandle(fileMapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = fileMapping;
+	mapping = view;
+	length = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (mapping != nullptr)
+	{
+		UnmapViewOfFile(mapping);
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+	}
+	mapping = nullptr;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	length = 0;
+}
+
+bool MappedFile::statFile(const std::string &path, std::uint64_t &size, std::int64_t &mtime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &info))
+	{
+		return false;
+	}
+	size = (std::uint64_t(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+	mtime = static_cast<std::int64_t>((std::uint64_t(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime);
+	return true;
+}
+
+#else
+
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+	void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // The mapping keeps its own reference to the file.
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	mapping = view;
+	length = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (mapping != nullptr)
+	{
+		munmap(mapping, length);
+	}
+	mapping = nullptr;
+	length = 0;
+}
+
+bool MappedFile::statFile(const std::string &path, std::uint64_t &size, std::int64_t &mtime)
+{
+	struct stat info;
+	if (::stat(path.c_str(), &info) != 0)
+	{
+		return false;
+	}
+	size = static_cast<std::uint64_t>(info.st_size);
+#if defined(__linux__)
+	mtime = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#else
+	mtime = static_cast<std::int64_t>(info.st_mtime);
+#endif
+	return true;
+}
+
+#endif
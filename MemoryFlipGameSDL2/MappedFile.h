@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A read-only view of a whole file mapped into memory.
+// Pages are faulted in by the OS as they are touched, so opening a large file costs next to nothing.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool open(const std::string &path);
+	void close();
+
+	bool isOpen() const { return mapping != nullptr; }
+	const unsigned char *data() const { return static_cast<const unsigned char *>(mapping); }
+	size_t size() const { return length; }
+
+	// Size and modification time of a file or directory in a single call, without opening it.
+	// The time is in the platform's native units, so only compare it with other values from here.
+	static bool statFile(const std::string &path, std::uint64_t &size, std::int64_t &mtime);
+
+private:
+	void *mapping = nullptr;
+	size_t length = 0;
+#if defined(_WIN32)
+	void *fileHandle = nullptr;
+	void *mappingHandle = nullptr;
+#endif
+};
@@ -2,16 +2,33 @@
 //
 
 #include "pch.h"
+#include "AssetIO.h"
+#include "AssetWatcher.h"
+#include "BoardPool.h"
+#include "DrawListBuffer.h"
+#include "FrameRenderer.h"
+#include "FrameStats.h"
+#include "BoardLayout.h"
+#include "Camera.h"
+#include "GameSession.h"
+#include "InputQueue.h"
+#include "PuzzleCache.h"
+#include "PuzzleManifest.h"
+#include "PuzzlePack.h"
+#include "SdlDestructors.h"
+#include "SdlSubsystems.h"
+#include "SheetLoader.h"
+#include "TextureAtlas.h"
+#include "Trace.h"
 #include <SDL.h>
 #include <SDL_image.h>
+#include <atomic>
 #include <iostream> // for debug
 #include <memory>
+#include <random>
 #include <string>
-#include <filesystem>
+#include <thread>
 #include <vector>
-#include <random>
-#include <chrono>
-#include <algorithm>
 
 // Important Note: 
 // The unique id needs to be stored with the src rectangle, NOT the dst rectangle.
@@ -42,15 +59,14 @@
 
 // Why it works to store it with src coordinates:
 // With the unique id and state being stored with the src coordinates, the mouseclick code looks something like this:
-// if (mouseWithinRectBound(sdlEvent.button, dstCoords[i]) && 
-// puzzlePiecesAll[i].visState == puzzlePiece::VisState::HIDDEN)
+// session.flip(boardLayout.tileAt(sdlEvent.button.x, sdlEvent.button.y))
 
 // With dstCoords having been shuffled, if we click on the first element of dstCoords,
 // we're also getting the state that is tied to the src image piece and the unique id.
 // This means that appearance/id/state are all linked up. 
 
 // So, for example, we click on point x=40, y=80. 
-// The related element for src is: id=1234567890, state=HIDDEN, srcCoordinates x=0, y=0
+// The related element for src is: pairId=0, state=HIDDEN, srcCoordinates x=0, y=0
 
 // The image is displayed, when two are displayed, their ids are checked duplication.
 // And if they are the same id, it's a match.
@@ -60,334 +76,968 @@
 
 
 
-std::random_device rd;
-std::mt19937 mt(rd());
+const char *windowTitle = "Memory Flip Game";
+const int windowWidth = 600;
+const int windowHeight = 600;
 
 const int puzzlePieceSize = 40; // 40x40
-const int puzzlePiecesTotal = 100;
 
-std::vector<SDL_Rect> srcCoords(puzzlePiecesTotal);
-std::vector<SDL_Rect> dstCoords(puzzlePiecesTotal);
+// A 10x10 board with a 5px gap, unless the MEMORYFLIP_BOARD environment variable asks for another size ("400x300").
+// Boards bigger than the window are scrolled and zoomed with the camera.
+// The default layout is constexpr, so its geometry is checked when the game is built.
+constexpr BoardLayout defaultBoard = { 75, 40, puzzlePieceSize, 5, 10, 10 };
+static_assert(defaultBoard.tilesTotal() % 2 == 0, "every piece on the default board needs a partner");
+static_assert(defaultBoard.tileAt(defaultBoard.tileX(defaultBoard.tilesTotal() - 1), defaultBoard.tileY(defaultBoard.tilesTotal() - 1)) == defaultBoard.tilesTotal() - 1,
+	"the last tile of the default board must be hit where it is drawn");
+static_assert(defaultBoard.tileAt(defaultBoard.originX + defaultBoard.pieceSize, defaultBoard.originY) == BoardLayout::noTile,
+	"the gaps between tiles must not hit any tile");
+BoardLayout loadBoardLayout();
+const BoardLayout boardLayout = loadBoardLayout();
 
-struct puzzlePiece
-{
-	SDL_Rect srcRect;
-	enum class VisState { HIDDEN, FLIPPED, SOLVED };
-	VisState visState = VisState::HIDDEN;
-	std::string id;
-};
-std::vector<puzzlePiece> puzzlePiecesAll(puzzlePiecesTotal);
-const int maxFlipped = 2; // The maximum number of "pieces" that can be in the flipped up state at the same time.
-int flippedCount = 0;
-std::vector<int> flippedIndices(2);
-int flipTimer = 0;
+// Every board is dealt from a 64-bit seed, which is logged so a board can be played again.
+// MEMORYFLIP_SEED fixes the seed of the first board; otherwise it is random.
+std::uint64_t loadSessionSeed();
+GameSession session(boardLayout.tilesTotal(), loadSessionSeed());
+
+// The boards after the first are dealt ahead of time for the following seeds, so starting one costs a swap.
+std::unique_ptr<BoardPool> boardPool;
+BoardPool::dealtBoard nextBoard;
 
+// Game time advances in fixed steps of real time, read from the performance counter, however often frames are drawn.
+// Each frame runs as many steps as real time has passed since the last one, so every game timer runs the same
+// at 30, 60 or 240 fps. Each command is applied once the steps up to its own event timestamp have run, not at the
+// end of the frame that picked it up, so a reveal timer starts when the click happened whatever the frame rate.
+const int logicRate = 120; // Steps per second.
+const Uint32 maxCatchUp = 1000; // ms of steps one frame may run; a longer stall (e.g. a debugger break) is skipped.
+Uint64 logicStepTicks = 0; // Performance counter ticks per step, set at startup.
+Uint64 logicLastCounter = 0;
+Uint64 logicAccumulator = 0; // Real time not yet simulated.
+Uint64 gameTicks = 0; // Game time, in performance counter ticks.
+const Uint32 revealDelay = 680; // ms a mismatched pair stays face up; the 41 frames it used to be counted in at 60 fps.
+Uint64 revealElapsed = 0; // Game time the current pair has been waiting.
 
+// Frames are capped at fpsCap. Only drawing follows it; game time runs on logicRate steps whatever the frame rate.
 const int fpsCap = 60;
 const int fpsDelay = 1000 / fpsCap;
 Uint32 fpsTimerStart;
 int fpsTimerElapsed;
+const int idleWaitTimeout = 500; // ms to block for input while nothing on the board is in motion.
 
-struct sdlDestructorWindow
-{
-	void operator()(SDL_Window *window) const
-	{
-		SDL_DestroyWindow(window);
-		SDL_Log("SDL_Window deleted");
-	}
-};
+// Where each frame's time goes. F3 toggles an overlay of per-phase p50/p99/max bars (the figures go in the window title),
+// and F4 writes the frames in the window to frameStatsCsvPath.
+FrameStats frameStats;
+bool statsOverlay = false;
+Uint32 statsRefreshed = 0;
+const Uint32 statsRefreshInterval = 500; // ms between overlay updates.
+FrameStats::summary statsShown[FrameStats::phaseCount];
+const char *frameStatsCsvPath = "framestats.csv";
 
-struct sdlDestructorRenderer
-{
-	void operator()(SDL_Renderer *renderer) const
-	{
-		SDL_DestroyRenderer(renderer);
-		SDL_Log("SDL_Renderer deleted");
-	}
-};
+// The window, its events and the renderer stay on the main thread, as SDL requires. Everything else runs on gameThread,
+// which describes each frame as a draw list for the main thread to draw and present, so a slow SDL_RenderPresent or
+// a vsync stall doesn't hold up the game's logic or timers. It does hold up input: the main thread pumps events
+// too, and SDL stamps them when they are pumped, so an event that arrives during a present is seen (and timed)
+// up to one present late.
+std::unique_ptr<SDL_Window, sdlDestructorWindow> window;
+std::unique_ptr<FrameRenderer> frameRenderer;
+const char *rendererCacheFile = "renderer.cache"; // In SDL's per-user preferences directory. Delete it to probe again.
+InputQueue inputQueue; // Main thread.
+CommandMailbox gameCommands; // Main thread to game thread.
+std::unique_ptr<DrawListBuffer> drawLists; // Game thread to main thread.
+std::vector<GameCommand> commands; // This frame's commands, on the game thread.
+std::thread gameThread;
+std::atomic<bool> gameRunning{ false };
+Uint32 wakeEvent = 0; // Pushed to wake the main thread when a draw list is published or the game stops.
 
-struct sdlDestructorTexture
-{
-	void operator()(SDL_Texture *texture) const
-	{
-		SDL_DestroyTexture(texture);
-		SDL_Log("SDL_Texture deleted");
-	}
+// The state textures and the resident puzzle sheets share one atlas, so the board draws from a single texture.
+// It belongs to frameRenderer; images are packed on the game thread and uploaded on the main thread.
+TextureAtlas *atlas = nullptr;
+AtlasRegion pieceHiddenRegion;
+AtlasRegion flippedOutlineRegion;
+int currentPuzzle = 0;
+AtlasRegion currentPuzzleRegion; // Pair n shows tile n of this sheet, in reading order.
+int currentSheetCols = 1;
+int currentSheetTiles = 1;
+
+// A board can have more pairs than its sheet has pictures. Pictures are then reused, tinted differently each time round.
+const SDL_Color pairTints[] = {
+	{ 255, 255, 255, 255 }, { 255, 170, 170, 255 }, { 170, 255, 170, 255 }, { 170, 170, 255, 255 },
+	{ 255, 255, 150, 255 }, { 150, 255, 255, 255 }, { 255, 150, 255, 255 }, { 190, 190, 190, 255 },
 };
+const int pairTintCount = sizeof(pairTints) / sizeof(pairTints[0]);
 
-std::unique_ptr<SDL_Window, sdlDestructorWindow> window;
-std::unique_ptr<SDL_Renderer, sdlDestructorRenderer> renderer;
-std::vector<std::unique_ptr<SDL_Texture, sdlDestructorTexture>> puzzleTextures;
-std::unique_ptr<SDL_Texture, sdlDestructorTexture> pieceHiddenTex;
-std::unique_ptr<SDL_Texture, sdlDestructorTexture> flippedOutlineTex;
+// Sheets are read through assetIO and decoded in the background; the game thread only packs them into the atlas.
+// Sheet tags are puzzle indices; the state textures use the negative tags below.
+AssetIO assetIO;
+std::unique_ptr<SheetLoader> sheetLoader;
+const int hiddenTextureTag = -1;
+const int outlineTextureTag = -2;
+const char *hiddenTexturePath = "textures/hiddenStateTexture.png";
+const char *outlineTexturePath = "textures/flippedStateOutlineTexture.png";
+
+// Pre-decoded copies of the textures and puzzles, written by running the game with --build-pack.
+// When it is present its images are registered with assetIO, so sheets come straight out of the mapped pack instead
+// of being decoded from PNG, unless their PNG changed after the pack was built.
+const char *assetPackPath = "assets.mfpack";
+PuzzlePack assetPack;
+
+// Remembers what is in puzzles/ between runs, so unchanged sheets are never enumerated or probed again.
+const char *puzzleManifestPath = "puzzles.manifest";
+
+// Puzzle sheets are only loaded when asked for, and the least recently used ones are dropped once the atlas pages
+// go past this budget.
+// The MEMORYFLIP_PUZZLE_CACHE_MB environment variable overrides it.
+const size_t puzzleCacheBudgetDefault = 32 * 1024 * 1024; // Two full atlas pages.
+std::unique_ptr<PuzzleCache> puzzleCache;
+
+// Textures and puzzle sheets that are saved while the game runs are decoded again and swapped in between frames.
+// This works with a pack loaded too: the pack hands out a file that changed since it was built as the file itself.
+AssetWatcher assetWatcher;
+std::vector<std::string> changedAssets;
+
+// The visible part of the board is drawn into a persistent, window-sized target and only the tiles that changed are redrawn.
+// Each present copies the whole target to the window, because the back buffer is undefined after a flip.
+const SDL_Color boardColor = { 242, 242, 242, 255 };
+// Set when the window needs repainting even though no tile changed (e.g. it was uncovered),
+// and while a frame is waiting for the main thread to take it.
+bool presentPending = true;
+
+// Moving the camera, or losing the target, means every visible tile has to be drawn again.
+Camera camera;
+bool viewDirty = true;
+const float zoomStep = 1.25f; // Zoom factor per mouse wheel step.
 
 enum class ProgramState { STARTUP, PLAY, TRANSITION, SHUTDOWN };
 ProgramState programState = ProgramState::STARTUP;
+int exitCode = 0;
 
-void programStartup();
+// Startup is measured from entering main() to the first frame on screen. With --first-frame-check [ms] the game exits
+// after that frame, with status 1 if it took longer than the budget, so a regression test can hold startup to it.
+Uint64 launchCounter = 0;
+double firstFrameMs = -1.0;
+double firstFrameBudgetMs = 1000.0;
+bool firstFrameCheck = false;
+
+// Between boards the solved puzzle is shown in full while the next puzzle's sheet loads in the background.
+// A click or NEW_GAME cuts the display short, but the next board only starts once its sheet is in.
+const Uint32 transitionDuration = 1500; // ms to show the solved puzzle.
+const Uint32 transitionGiveUp = 10000; // ms to wait for the next sheet before playing the current puzzle again.
+Uint64 transitionStart = 0; // Game time.
+int transitionPuzzle = 0; // The puzzle the next board will use.
+bool transitionSkip = false;
+bool revealSolved = false; // Draw solved tiles face up instead of leaving their places empty.
+
+bool programStartup();
+int sheetTilesNeeded();
+std::vector<std::string> listPuzzles(int minTiles);
+int buildAssetPack(const std::string &outPath);
+void uploadSheet(int tag, SDL_Surface *surface);
+bool startupSheetsReady(int puzzleI);
+void clampCamera();
+void reloadChangedAssets();
+void selectPuzzle(int puzzleI);
+void startNewBoard();
+void advanceLogic(Uint64 until);
+void stepLogic();
+Uint64 msToTicks(Uint32 ms);
+Uint32 gameMsSince(Uint64 start);
+void beginTransition();
+Uint32 transitionTimeout();
+void updateTransition();
+void recordFirstFrame();
 void programShutdown();
+void gameLoop();
+void capFrameRate();
+void presentFrame();
 void eventPoll();
 void renderUpdate();
-void shufflePuzzlePieces();
-bool mouseWithinRectBound(const SDL_MouseButtonEvent &btn, const SDL_Rect &rect);
-bool puzzleSolved();
+void drawTile(int rectI);
+void drawPicture(int rectI, const SDL_Rect &dst);
+bool frameWorkPending();
+void updateStatsOverlay();
+void drawStatsOverlay();
 
 int main(int argc, char *argv[])
 {
+	launchCounter = SDL_GetPerformanceCounter();
+	if (argc >= 2 && std::string(argv[1]) == "--build-pack")
+	{
+		return buildAssetPack(argc >= 3 ? argv[2] : assetPackPath);
+	}
+	if (argc >= 2 && std::string(argv[1]) == "--first-frame-check")
+	{
+		firstFrameCheck = true;
+		if (argc >= 3)
+		{
+			firstFrameBudgetMs = SDL_atof(argv[2]);
+		}
+	}
+
+	// MEMORYFLIP_TRACE=<file> records startup and every frame, and writes a Chrome trace to file on exit (or on SIGUSR1).
+	if (const char *tracePath = SDL_getenv("MEMORYFLIP_TRACE"))
+	{
+		Trace::start(tracePath);
+		Trace::nameThread("main");
+	}
+
+	if (!programStartup())
+	{
+		exitCode = 1;
+		programShutdown();
+		return exitCode;
+	}
+	programState = ProgramState::PLAY;
+	gameRunning = true;
+	gameThread = std::thread(gameLoop);
+
+	// The main thread only pumps events over to the game thread and puts the frames it sends back on screen.
+	while (gameRunning)
+	{
+		Trace::pollDumpRequest();
+		{
+			TraceSpan span("wait for events");
+			SDL_WaitEventTimeout(NULL, idleWaitTimeout);
+		}
+		inputQueue.gather();
+		gameCommands.post(inputQueue.commands());
+		presentFrame();
+	}
+	gameThread.join();
+
+	programShutdown();
+
+	return exitCode;
+}
+
+// The game's own loop, on gameThread.
+void gameLoop()
+{
+	Trace::nameThread("game");
 	while (programState != ProgramState::SHUTDOWN)
 	{
 		switch (programState)
 		{
-		case (ProgramState::STARTUP):
-			programStartup();
-			programState = ProgramState::PLAY;
-			break;
 		case (ProgramState::PLAY):
+			if (!frameWorkPending())
+			{
+				// Idle: sleep until input arrives instead of spinning frames nobody will see.
+				TraceSpan span("idle");
+				gameCommands.wait(idleWaitTimeout);
+			}
+			fpsTimerStart = SDL_GetTicks();
+			frameStats.beginFrame();
+			eventPoll();
+			renderUpdate();
+			frameStats.endFrame();
+			updateStatsOverlay();
+			capFrameRate();
+			break;
+		case (ProgramState::TRANSITION):
+			// Nothing moves while the result is up, so sleep until input arrives or there is something to check.
+			// Input wakes the wait at once, so the frame is capped like in PLAY or a flood of motion would spin it.
+			gameCommands.wait(transitionTimeout());
 			fpsTimerStart = SDL_GetTicks();
+			frameStats.beginFrame();
 			eventPoll();
 			renderUpdate();
-			fpsTimerElapsed = SDL_GetTicks() - fpsTimerStart;
-			if (fpsDelay > fpsTimerElapsed)
+			frameStats.endFrame();
+			updateStatsOverlay();
+			if (programState == ProgramState::TRANSITION)
 			{
-				SDL_Delay(fpsDelay - fpsTimerElapsed);
+				updateTransition();
 			}
+			capFrameRate();
 			break;
-		case (ProgramState::TRANSITION):
+		default:
 			break;
 		}
 	}
 
-	programShutdown();
-
-	return 0;
+	gameRunning = false;
+	SDL_Event wake;
+	SDL_zero(wake);
+	wake.type = wakeEvent;
+	SDL_PushEvent(&wake);
 }
 
-void programStartup()
+// Sleeps out the rest of the frame that started at fpsTimerStart, so the game thread runs at most fpsCap frames a second.
+void capFrameRate()
 {
-	SDL_Init(SDL_INIT_EVERYTHING);
+	fpsTimerElapsed = SDL_GetTicks() - fpsTimerStart;
+	if (fpsDelay > fpsTimerElapsed)
+	{
+		SDL_Delay(fpsDelay - fpsTimerElapsed);
+	}
+}
 
-	window.reset(SDL_CreateWindow("Memory Flip Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 600, 600, false));
-	renderer.reset(SDL_CreateRenderer(window.get(), -1, 0));
-	SDL_SetRenderDrawColor(renderer.get(), 242, 242, 242, 255);
+// Draws and presents the frame the game thread published, if there is one. Main thread.
+void presentFrame()
+{
+	const DrawList *list = drawLists->acquire();
+	if (list == NULL)
+	{
+		return;
+	}
+	if (!list->title.empty())
+	{
+		SDL_SetWindowTitle(window.get(), list->title.c_str());
+	}
+	frameRenderer->draw(*list);
+	drawLists->release();
+	if (firstFrameMs < 0.0)
+	{
+		recordFirstFrame();
+	}
+}
 
-	// Get texture for hidden state pieces.
+// Returns false if the game can't start (no display, no renderer, nothing to play), after logging why.
+bool programStartup()
+{
+	TraceSpan startupSpan("programStartup");
+	// The game only needs video (which brings events with it). SDL_GetTicks and SDL_Delay work without the timer subsystem.
+	if (!SdlSubsystems::require(SDL_INIT_VIDEO, "video"))
 	{
-		SDL_Surface *tmpSurface;
-		tmpSurface = IMG_Load("textures/hiddenStateTexture.png");
-		pieceHiddenTex.reset(SDL_CreateTextureFromSurface(renderer.get(), tmpSurface));
-		SDL_FreeSurface(tmpSurface);
+		return false;
+	}
+	wakeEvent = SDL_RegisterEvents(1);
 
-		tmpSurface = IMG_Load("textures/flippedStateOutlineTexture.png");
-		flippedOutlineTex.reset(SDL_CreateTextureFromSurface(renderer.get(), tmpSurface));
-		SDL_FreeSurface(tmpSurface);
+	{
+		TraceSpan span("create window and renderer");
+		// The window stays hidden while the render drivers are benchmarked in it, the first time round on this machine.
+		window.reset(SDL_CreateWindow(windowTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, SDL_WINDOW_HIDDEN));
+		if (!window)
+		{
+			SDL_Log("Could not create the window: %s", SDL_GetError());
+			return false;
+		}
+		std::string rendererCachePath = rendererCacheFile;
+		if (char *prefPath = SDL_GetPrefPath("MemoryFlip", "MemoryFlipGame"))
+		{
+			rendererCachePath = prefPath + rendererCachePath;
+			SDL_free(prefPath);
+		}
+		frameRenderer.reset(new FrameRenderer(window.get(), rendererCachePath, windowWidth, windowHeight));
+		if (!frameRenderer->ready())
+		{
+			return false;
+		}
+		SDL_ShowWindow(window.get());
 	}
+	camera.viewWidth = windowWidth;
+	camera.viewHeight = windowHeight;
+	clampCamera();
+
+	atlas = &frameRenderer->atlas();
+	drawLists.reset(new DrawListBuffer(wakeEvent));
+	sheetLoader.reset(new SheetLoader(assetIO));
 
-	// Store puzzle image textures in vector of unique pointers.
+	// Only sheets with enough pictures for every pair to look different are played.
+	const int minTiles = sheetTilesNeeded();
+	std::vector<std::string> puzzlePaths;
+	if (assetPack.open(assetPackPath))
 	{
-		std::string puzzlesPath = "puzzles/";
-		auto dirIter = std::experimental::filesystem::directory_iterator(puzzlesPath);
-		for (auto& file : dirIter)
+		assetPack.registerWith(assetIO);
+		for (int i = 0; i < assetPack.entryCount(); i++)
 		{
-			if (file.path().filename().string().find(".png") != std::string::npos)
+			const PuzzlePack::packEntry &entry = assetPack.entry(i);
+			const std::string name = entry.name;
+			if (name.compare(0, 8, "puzzles/") == 0 && static_cast<int>(entry.tileCount) >= minTiles)
 			{
-				SDL_Surface *tmpSurface;
-				tmpSurface = IMG_Load(file.path().string().c_str());
-				std::unique_ptr<SDL_Texture, sdlDestructorTexture> puzzleTex;
-				puzzleTex.reset(SDL_CreateTextureFromSurface(renderer.get(), tmpSurface));
-				puzzleTextures.push_back(std::move(puzzleTex));
-				SDL_FreeSurface(tmpSurface);
+				puzzlePaths.push_back(name);
 			}
 		}
 	}
+	else
+	{
+		puzzlePaths = listPuzzles(minTiles);
+	}
+	assetWatcher.watch("textures/");
+	assetWatcher.watch("puzzles/");
+	if (puzzlePaths.empty())
+	{
+		SDL_Log("No puzzle sheet in puzzles/ or %s has the %d pictures a %dx%d board needs; try a smaller MEMORYFLIP_BOARD",
+			assetPackPath, minTiles, boardLayout.cols, boardLayout.rows);
+		return false;
+	}
+
+	// Decode the textures for hidden and flipped state pieces first, then the first puzzle image.
+	sheetLoader->request(hiddenTexturePath, hiddenTextureTag);
+	sheetLoader->request(outlineTexturePath, outlineTextureTag);
+	{
+		size_t budget = puzzleCacheBudgetDefault;
+		if (const char *budgetMb = SDL_getenv("MEMORYFLIP_PUZZLE_CACHE_MB"))
+		{
+			budget = static_cast<size_t>(SDL_atoi(budgetMb)) * 1024 * 1024;
+		}
+		puzzleCache.reset(new PuzzleCache(*atlas, *sheetLoader, puzzlePaths, puzzlePieceSize, minTiles, budget));
+	}
 
-	// Set src coords.
+	// Play can start as soon as the state textures and the first puzzle that loads are in.
+	// The manifest only reads each sheet's header, so a damaged sheet, or one that changed since, is only found out here;
+	// it is skipped.
+	int firstPuzzle = 0;
 	{
-		int xOffset = 0;
-		int yOffset = 0;
-		int rowCount = 0;
-		const int xRowLen = (sqrt(puzzlePiecesTotal) / 2) - 1;
-		const int sizeHalf = puzzlePiecesTotal / 2;
+		TraceSpan span("wait for startup sheets");
+		puzzleCache->acquire(firstPuzzle);
+		for (;;)
 		{
-			for (int rectI = 0; rectI < sizeHalf; rectI++)
+			while (!startupSheetsReady(firstPuzzle) && sheetLoader->busy())
+			{
+				sheetLoader->deliver(uploadSheet, true);
+			}
+			if (pieceHiddenRegion.page < 0 || flippedOutlineRegion.page < 0)
+			{
+				SDL_Log("Could not load the piece textures %s and %s", hiddenTexturePath, outlineTexturePath);
+				return false;
+			}
+			if (puzzleCache->resident(firstPuzzle))
 			{
-				puzzlePiecesAll[rectI].srcRect.w = puzzlePieceSize;
-				puzzlePiecesAll[rectI].srcRect.h = puzzlePieceSize;
-				puzzlePiecesAll[rectI].srcRect.x = xOffset;
-				puzzlePiecesAll[rectI].srcRect.y = yOffset;
-
-				std::string str = "";
-				std::uniform_int_distribution<int> dist(1, 9);
-				for (int i = 0; i < 10; i++)
-				{
-					str += std::to_string(dist(mt));
-				}
-				puzzlePiecesAll[rectI].id = str;
-
-				if (rowCount >= xRowLen)
-				{
-					rowCount = 0;
-					xOffset = 0;
-					yOffset += puzzlePieceSize;
-				}
-				else
-				{
-					xOffset += puzzlePieceSize;
-					rowCount++;
-				}
+				break;
 			}
+			SDL_Log("Skipping %s: it could not be loaded", puzzlePaths[firstPuzzle].c_str());
+			if (++firstPuzzle == puzzleCache->puzzleCount())
+			{
+				SDL_Log("None of the puzzle sheets could be loaded");
+				return false;
+			}
+			puzzleCache->acquire(firstPuzzle);
 		}
+	}
+	selectPuzzle(firstPuzzle);
+	SDL_Log("Board seed %llu", static_cast<unsigned long long>(session.seed()));
+	boardPool.reset(new BoardPool(boardLayout.tilesTotal(), session.seed() + 1));
+
+	logicStepTicks = SDL_GetPerformanceFrequency() / logicRate;
+	logicLastCounter = SDL_GetPerformanceCounter();
+	return true;
+}
 
+BoardLayout loadBoardLayout()
+{
+	BoardLayout layout = defaultBoard;
+	if (const char *size = SDL_getenv("MEMORYFLIP_BOARD"))
+	{
+		int cols = 0;
+		int rows = 0;
+		if (SDL_sscanf(size, "%dx%d", &cols, &rows) == 2 && cols > 0 && rows > 0 &&
+			cols <= 2 * GameSession::maxPairs / rows && (cols * rows) % 2 == 0)
+		{
+			layout.cols = cols;
+			layout.rows = rows;
+		}
+		else
 		{
-			std::copy(puzzlePiecesAll.begin(), puzzlePiecesAll.begin() + sizeHalf, puzzlePiecesAll.begin() + sizeHalf);
+			SDL_Log("Ignoring MEMORYFLIP_BOARD=%s: expected COLSxROWS with an even tile count of at most %d", size, GameSession::maxPairs * 2);
 		}
 	}
+	return layout;
+}
+
+std::uint64_t loadSessionSeed()
+{
+	if (const char *seed = SDL_getenv("MEMORYFLIP_SEED"))
+	{
+		return SDL_strtoull(seed, NULL, 0);
+	}
+	std::random_device entropy;
+	return (std::uint64_t(entropy()) << 32) | entropy();
+}
+
+// Each picture is shown once per tint, so a sheet needs this many tiles for no two pairs on the board to look alike.
+int sheetTilesNeeded()
+{
+	const int pairs = boardLayout.tilesTotal() / 2;
+	return (pairs + pairTintCount - 1) / pairTintCount;
+}
+
+// Every sheet in puzzles/ with at least minTiles whole tiles.
+std::vector<std::string> listPuzzles(int minTiles)
+{
+	PuzzleManifest manifest(puzzleManifestPath, "puzzles/", puzzlePieceSize);
+	manifest.refresh();
 
-	// Set dst coords.
+	std::vector<std::string> puzzlePaths;
+	for (const auto &sheet : manifest.sheets())
 	{
-		const int xBoardOffset = 75;
-		const int yBoardOffset = 40;
-		const int betweenPiecesOffset = 5;
-		int xOffset = 0;
-		int yOffset = 0;
-		int rowCount = 0;
-		const int xRowLen = sqrt(puzzlePiecesTotal) - 1;
-		for (auto& rect : dstCoords)
+		if (sheet.valid && sheet.tileCount >= minTiles)
 		{
-			rect.w = puzzlePieceSize;
-			rect.h = puzzlePieceSize;
-			rect.x = xOffset + xBoardOffset;
-			rect.y = yOffset + yBoardOffset;
+			puzzlePaths.push_back(sheet.path);
+		}
+	}
+	return puzzlePaths;
+}
 
-			if (rowCount >= xRowLen)
-			{
-				rowCount = 0;
-				xOffset = 0;
-				yOffset += puzzlePieceSize + betweenPiecesOffset;
-			}
-			else
+// Offline step: decode every texture and puzzle once and store the pixels in the format the atlas uses.
+int buildAssetPack(const std::string &outPath)
+{
+	std::vector<std::string> sources = { hiddenTexturePath, outlineTexturePath };
+	const std::vector<std::string> puzzlePaths = listPuzzles(0); // The pack serves any board size, so it takes every sheet.
+	sources.insert(sources.end(), puzzlePaths.begin(), puzzlePaths.end());
+	return PuzzlePack::build(outPath, sources, puzzlePieceSize, SDL_PIXELFORMAT_ARGB8888) ? 0 : 1;
+}
+
+void uploadSheet(int tag, SDL_Surface *surface)
+{
+	TraceSpan span("upload sheet");
+	if (tag >= 0)
+	{
+		puzzleCache->upload(tag, surface);
+		if (tag == currentPuzzle && puzzleCache->resident(tag))
+		{
+			// A reload may have moved the sheet within the atlas, and either way the board shows stale pixels.
+			selectPuzzle(tag);
+		}
+		return;
+	}
+
+	AtlasRegion &region = tag == hiddenTextureTag ? pieceHiddenRegion : flippedOutlineRegion;
+	if (region.page >= 0)
+	{
+		// Reloaded: overwrite it in place if it kept its size, otherwise move it.
+		viewDirty = true;
+		if (atlas->replace(region, surface))
+		{
+			return;
+		}
+		atlas->release(region);
+	}
+
+	region = atlas->add(surface);
+	if (region.page < 0)
+	{
+		SDL_Log("Could not load sheet %d into the texture atlas", tag);
+	}
+}
+
+bool startupSheetsReady(int puzzleI)
+{
+	return pieceHiddenRegion.page >= 0 && flippedOutlineRegion.page >= 0 && puzzleCache->resident(puzzleI);
+}
+
+void reloadChangedAssets()
+{
+	changedAssets.clear();
+	assetWatcher.poll(changedAssets);
+	for (const auto &path : changedAssets)
+	{
+		const std::string name = AssetIO::normalizeName(path);
+		assetIO.unregister(name); // A packed copy is out of date now.
+		if (name == hiddenTexturePath)
+		{
+			sheetLoader->request(hiddenTexturePath, hiddenTextureTag);
+		}
+		else if (name == outlineTexturePath)
+		{
+			sheetLoader->request(outlineTexturePath, outlineTextureTag);
+		}
+		else
+		{
+			const int puzzleI = puzzleCache->find(name);
+			if (puzzleI >= 0)
 			{
-				xOffset += puzzlePieceSize + betweenPiecesOffset;
-				rowCount++;
+				puzzleCache->reload(puzzleI);
 			}
 		}
 	}
+}
+
+// Show a resident puzzle, and keep it resident while it is on screen.
+// The cache never makes a sheet resident that has too few pictures for the board, so every pair looks different.
+void selectPuzzle(int puzzleI)
+{
+	currentPuzzle = puzzleI;
+	currentPuzzleRegion = puzzleCache->acquire(puzzleI);
+	puzzleCache->pin(puzzleI);
+	currentSheetCols = std::max(1, currentPuzzleRegion.rect.w / puzzlePieceSize);
+	currentSheetTiles = std::max(1, currentSheetCols * (currentPuzzleRegion.rect.h / puzzlePieceSize));
+	viewDirty = true;
+}
 
-	shufflePuzzlePieces();
+void startNewBoard()
+{
+	TraceSpan span("startNewBoard");
+	boardPool->take(nextBoard);
+	session.reset(nextBoard.seed, nextBoard.pairIds);
+	revealElapsed = 0;
+	viewDirty = true;
+	SDL_Log("Board seed %llu", static_cast<unsigned long long>(session.seed()));
+}
+
+// Runs the steps that real time is owed up to until, a performance counter value. Times already covered are ignored.
+void advanceLogic(Uint64 until)
+{
+	if (until <= logicLastCounter)
+	{
+		return;
+	}
+	logicAccumulator = std::min(logicAccumulator + (until - logicLastCounter), msToTicks(maxCatchUp));
+	logicLastCounter = until;
+	while (logicAccumulator >= logicStepTicks)
+	{
+		stepLogic();
+		logicAccumulator -= logicStepTicks;
+	}
+}
+
+void stepLogic()
+{
+	gameTicks += logicStepTicks;
+	if (!session.resolvePending())
+	{
+		revealElapsed = 0;
+		return;
+	}
+	revealElapsed += logicStepTicks;
+	if (revealElapsed >= msToTicks(revealDelay))
+	{
+		revealElapsed = 0;
+		if (session.resolve() == GameSession::ResolveResult::MATCH && session.solved())
+		{
+			beginTransition();
+		}
+	}
+}
+
+Uint64 msToTicks(Uint32 ms)
+{
+	return ms * SDL_GetPerformanceFrequency() / 1000;
+}
+
+Uint32 gameMsSince(Uint64 start)
+{
+	return static_cast<Uint32>((gameTicks - start) * 1000 / SDL_GetPerformanceFrequency());
+}
+
+void beginTransition()
+{
+	programState = ProgramState::TRANSITION;
+	transitionStart = gameTicks;
+	transitionSkip = false;
+	revealSolved = true;
+	viewDirty = true;
+
+	// The next board is already dealt in the pool; start its sheet loading while the result is shown.
+	transitionPuzzle = (currentPuzzle + 1) % puzzleCache->puzzleCount();
+	puzzleCache->acquire(transitionPuzzle);
+}
+
+// How long the transition can sleep before something needs checking. Sheet deliveries and the main thread
+// taking a frame don't wake gameCommands.wait(), so while either is pending the transition looks again every frame.
+Uint32 transitionTimeout()
+{
+	if (sheetLoader->busy() || presentPending)
+	{
+		return fpsDelay;
+	}
+	// Plus a step, so the game clock has reached the end of the display by the time this wakes.
+	const Uint32 elapsed = gameMsSince(transitionStart);
+	const Uint32 remaining = transitionDuration - elapsed + 1000 / logicRate + 1;
+	return elapsed < transitionDuration && !transitionSkip ? std::min<Uint32>(remaining, idleWaitTimeout) : idleWaitTimeout;
+}
+
+void updateTransition()
+{
+	const Uint32 elapsed = gameMsSince(transitionStart);
+	const bool nextReady = puzzleCache->resident(transitionPuzzle);
+	if ((elapsed < transitionDuration && !transitionSkip) || (!nextReady && elapsed < transitionGiveUp))
+	{
+		return;
+	}
+
+	if (nextReady)
+	{
+		selectPuzzle(transitionPuzzle);
+	}
+	else
+	{
+		SDL_Log("Puzzle %d did not load in time; playing puzzle %d again", transitionPuzzle, currentPuzzle);
+	}
+	startNewBoard();
+	revealSolved = false;
+	programState = ProgramState::PLAY;
+}
+
+// Keeps the camera over the board. The world is never smaller than the window, so a board that fits stays where its
+// layout puts it at 100% zoom.
+void clampCamera()
+{
+	camera.clampTo(std::max(windowWidth, boardLayout.originX * 2 + boardLayout.width()),
+		std::max(windowHeight, boardLayout.originY * 2 + boardLayout.height()));
+}
+
+void recordFirstFrame()
+{
+	firstFrameMs = (SDL_GetPerformanceCounter() - launchCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+	SdlSubsystems::logReport();
+	const bool overBudget = firstFrameMs > firstFrameBudgetMs;
+	SDL_Log("Startup: first frame after %.1f ms (%.1f ms in SDL subsystems), budget %.0f ms%s",
+		firstFrameMs, SdlSubsystems::totalMs(), firstFrameBudgetMs, overBudget ? " - OVER BUDGET" : "");
+	if (firstFrameCheck)
+	{
+		exitCode = overBudget ? 1 : 0;
+		GameCommand quit;
+		quit.type = GameCommand::Type::QUIT;
+		quit.timestamp = SDL_GetTicks();
+		gameCommands.post(std::vector<GameCommand>(1, quit));
+	}
 }
 
 void programShutdown()
 {
+	if (puzzleCache)
+	{
+		const PuzzleCache::cacheStats &stats = puzzleCache->stats();
+		SDL_Log("Puzzle cache: %d hits, %d misses, %d evictions, %u bytes resident in %u bytes of atlas pages",
+			stats.hits, stats.misses, stats.evictions, static_cast<unsigned>(stats.residentBytes),
+			static_cast<unsigned>(atlas->textureBytes()));
+	}
+	boardPool.reset();
+	sheetLoader.reset();
+	drawLists.reset();
+	atlas = nullptr;
+	frameRenderer.reset();
+	Trace::write();
 	SDL_Quit();
 }
 
 void eventPoll()
 {
-	SDL_Event sdlEvent;
-	SDL_PollEvent(&sdlEvent);
+	TraceSpan span("eventPoll");
+	// Upload any sheets that finished decoding since the last frame, and start decoding any that were edited.
+	sheetLoader->deliver(uploadSheet);
+	reloadChangedAssets();
+	frameStats.endPhase(FrameStats::Phase::LOGIC);
 
-	switch (sdlEvent.type)
+	// INPUT is mostly the main thread draining SDL's queue since the last frame; taking the commands here is just a swap.
+	gameCommands.take(commands);
+	frameStats.endPhase(FrameStats::Phase::INPUT);
+	frameStats.addTime(FrameStats::Phase::INPUT, inputQueue.takeGatherMs());
+	// Game time is caught up to each command's event time before it is applied, then to now.
+	// SDL stamps events in SDL_GetTicks() ms, so the counter value of each is found from how long ago it was.
+	const Uint64 now = SDL_GetPerformanceCounter();
+	const Uint32 nowMs = SDL_GetTicks();
+	for (const GameCommand &cmd : commands)
 	{
-	case SDL_QUIT:
-		programState = ProgramState::SHUTDOWN;
-		break;
-	case SDL_MOUSEBUTTONDOWN:
-		if (sdlEvent.button.button == SDL_BUTTON_LEFT)
+		const Uint32 age = nowMs - cmd.timestamp;
+		advanceLogic(now - std::min(msToTicks(age), now));
+		switch (cmd.type)
 		{
-			for (int i = 0; i < puzzlePiecesTotal; i++)
+		case GameCommand::Type::QUIT:
+			programState = ProgramState::SHUTDOWN;
+			break;
+		case GameCommand::Type::NEW_GAME:
+			if (programState == ProgramState::TRANSITION)
 			{
-				if (mouseWithinRectBound(sdlEvent.button, dstCoords[i]) && 
-					puzzlePiecesAll[i].visState == puzzlePiece::VisState::HIDDEN)
-				{
-					if (flippedCount < maxFlipped)
-					{
-						if (flippedCount == 0)
-						{
-							flippedIndices[0] = i;
-						}
-						else if (flippedCount == 1)
-						{
-							flippedIndices[1] = i;
-						}
-						puzzlePiecesAll[i].visState = puzzlePiece::VisState::FLIPPED;
-						flippedCount++;
-						break;
-					}
-					break;
-				}
+				transitionSkip = true;
+				break;
 			}
-		}
-		break;
-	}
-
-	if (flippedCount >= maxFlipped)
-	{		
-		flipTimer++;
-		if (flipTimer > 40)
+			startNewBoard();
+			break;
+		case GameCommand::Type::REPAINT:
+			presentPending = true;
+			break;
+		case GameCommand::Type::TOGGLE_STATS:
+			statsOverlay = !statsOverlay;
+			statsRefreshed = 0;
+			presentPending = true;
+			if (!statsOverlay)
+			{
+				drawLists->back().title = windowTitle;
+			}
+			break;
+		case GameCommand::Type::DUMP_STATS:
+			if (frameStats.writeCsv(frameStatsCsvPath))
+			{
+				SDL_Log("Wrote %d frames to %s", frameStats.frames(), frameStatsCsvPath);
+			}
+			break;
+		case GameCommand::Type::TARGETS_RESET:
+			// The board target's contents were lost, so every tile has to be drawn again.
+			viewDirty = true;
+			break;
+		case GameCommand::Type::PAN:
+			camera.pan(cmd.dx, cmd.dy);
+			clampCamera();
+			viewDirty = true;
+			break;
+		case GameCommand::Type::ZOOM:
+			camera.zoomAt(cmd.x, cmd.y, std::pow(zoomStep, static_cast<float>(cmd.dy)));
+			clampCamera();
+			viewDirty = true;
+			break;
+		case GameCommand::Type::CLICK:
 		{
-			if (puzzlePiecesAll[flippedIndices[0]].id == puzzlePiecesAll[flippedIndices[1]].id)
+			if (programState == ProgramState::TRANSITION)
 			{
-				puzzlePiecesAll[flippedIndices[0]].visState = puzzlePiece::VisState::SOLVED;
-				puzzlePiecesAll[flippedIndices[1]].visState = puzzlePiece::VisState::SOLVED;
-				if (puzzleSolved())
-				{
-					programState = ProgramState::TRANSITION;
-				}
+				transitionSkip = true;
+				break;
 			}
-			else
+			const int i = boardLayout.tileAt(camera.toWorldX(cmd.x), camera.toWorldY(cmd.y));
+			if (i != BoardLayout::noTile)
 			{
-				puzzlePiecesAll[flippedIndices[0]].visState = puzzlePiece::VisState::HIDDEN;
-				puzzlePiecesAll[flippedIndices[1]].visState = puzzlePiece::VisState::HIDDEN;
+				session.flip(i);
 			}
-			flippedCount = 0;
-			flipTimer = 0;
+			break;
+		}
+		case GameCommand::Type::POINTER_MOVE:
+			break;
 		}
 	}
+
+	advanceLogic(now);
+	frameStats.endPhase(FrameStats::Phase::LOGIC);
 }
 
 void renderUpdate()
 {
-	SDL_RenderClear(renderer.get());
-	for (int rectI = 0; rectI < puzzlePiecesTotal; rectI++)
+	// Whatever the main thread drew and presented since the last frame is charged to this one.
+	frameStats.addTime(FrameStats::Phase::PRESENT, frameRenderer->takeRenderMs());
+
+	if (!viewDirty && !session.changedMask().any() && !presentPending)
+	{
+		return;
+	}
+	TraceSpan span("renderUpdate");
+
+	// Only tiles inside the view are ever visited, so the cost of a frame follows the window size, not the board size.
+	const Camera::tileRange visible = camera.visibleTiles(boardLayout);
+	DrawList &list = drawLists->back();
+	if (viewDirty)
+	{
+		// Anything still queued for the board from a frame the main thread hasn't taken yet would only be drawn over.
+		list.board.clear();
+		list.clearBoard = true;
+		list.clearColor = boardColor;
+		for (int row = visible.row0; row < visible.row1; row++)
+		{
+			for (int col = visible.col0; col < visible.col1; col++)
+			{
+				drawTile(row * boardLayout.cols + col);
+			}
+		}
+	}
+	else
 	{
-		if (puzzlePiecesAll[rectI].visState == puzzlePiece::VisState::HIDDEN)
+		for (int row = visible.row0; row < visible.row1; row++)
 		{
-			SDL_RenderCopy(renderer.get(), pieceHiddenTex.get(), NULL, &dstCoords[rectI]);
+			session.changedMask().forEachSetInRange(row * boardLayout.cols + visible.col0, row * boardLayout.cols + visible.col1, drawTile);
 		}
-		else if (puzzlePiecesAll[rectI].visState == puzzlePiece::VisState::FLIPPED)
+	}
+	// Changes outside the view are dropped too; those tiles get drawn whenever the camera brings them in.
+	session.clearChanged();
+	viewDirty = false;
+
+	// The overlay is drawn from scratch on every present, so only the latest one matters.
+	list.overlay.clear();
+	if (statsOverlay)
+	{
+		drawStatsOverlay();
+	}
+	// If the main thread is still busy with the last frame, this one stays in the list and the next frame adds to it.
+	presentPending = !drawLists->submit();
+	frameStats.endPhase(FrameStats::Phase::RENDER);
+}
+
+void drawTile(int rectI)
+{
+	const int worldX = boardLayout.tileX(rectI);
+	const int worldY = boardLayout.tileY(rectI);
+	const int screenX = camera.toScreenX(worldX);
+	const int screenY = camera.toScreenY(worldY);
+	const SDL_Rect dst = { screenX, screenY, camera.toScreenX(worldX + puzzlePieceSize) - screenX, camera.toScreenY(worldY + puzzlePieceSize) - screenY };
+	std::vector<DrawCommand> &board = drawLists->back().board;
+	board.push_back(DrawCommand::fill(rectI, dst, boardColor));
+	switch (session.visState(rectI))
+	{
+	case GameSession::VisState::HIDDEN:
+		board.push_back(DrawCommand::copy(rectI, pieceHiddenRegion.page, pieceHiddenRegion.rect, dst, pairTints[0]));
+		break;
+	case GameSession::VisState::FLIPPED:
+		drawPicture(rectI, dst);
+		board.push_back(DrawCommand::copy(rectI, flippedOutlineRegion.page, flippedOutlineRegion.rect, dst, pairTints[0]));
+		break;
+	case GameSession::VisState::SOLVED:
+		if (revealSolved)
 		{
-			SDL_RenderCopy(renderer.get(), puzzleTextures[0].get(), &puzzlePiecesAll[rectI].srcRect, &dstCoords[rectI]);
-			SDL_RenderCopy(renderer.get(), flippedOutlineTex.get(), NULL, &dstCoords[rectI]);
+			drawPicture(rectI, dst);
 		}
+		break;
 	}
-	SDL_RenderPresent(renderer.get());
 }
 
-void shufflePuzzlePieces()
+void drawPicture(int rectI, const SDL_Rect &dst)
+{
+	const int pairI = session.pairId(rectI);
+	const int pictureI = pairI % currentSheetTiles;
+	const SDL_Rect src = {
+		currentPuzzleRegion.rect.x + (pictureI % currentSheetCols) * puzzlePieceSize,
+		currentPuzzleRegion.rect.y + (pictureI / currentSheetCols) * puzzlePieceSize,
+		puzzlePieceSize, puzzlePieceSize };
+	const SDL_Color &tint = pairTints[(pairI / currentSheetTiles) % pairTintCount];
+	drawLists->back().board.push_back(DrawCommand::copy(rectI, currentPuzzleRegion.page, src, dst, tint));
+}
+
+// True while something has to happen on the next frame without any new input:
+// a flipped pair is waiting for its reveal timer, the board or the view has changes not yet presented,
+// or puzzle sheets are still arriving from the loader.
+bool frameWorkPending()
 {
-	int seed = std::chrono::system_clock::now().time_since_epoch().count();
-	shuffle(puzzlePiecesAll.begin(), puzzlePiecesAll.end(), std::default_random_engine(seed));
+	return session.resolvePending() || session.changedMask().any() || viewDirty || presentPending || sheetLoader->busy();
 }
 
-bool mouseWithinRectBound(const SDL_MouseButtonEvent &btn, const SDL_Rect &rect)
+// Refreshes the overlay's figures every statsRefreshInterval while it is shown, and asks for a present to show them.
+void updateStatsOverlay()
 {
-	if (btn.x >= rect.x &&
-		btn.x <= rect.x + rect.w &&
-		btn.y >= rect.y &&
-		btn.y <= rect.y + rect.h)
+	const Uint32 now = SDL_GetTicks();
+	if (!statsOverlay || (statsRefreshed != 0 && now - statsRefreshed < statsRefreshInterval))
+	{
+		return;
+	}
+	statsRefreshed = now;
+
+	char title[512];
+	int length = SDL_snprintf(title, sizeof(title), "%s -", windowTitle);
+	for (int phaseI = 0; phaseI < FrameStats::phaseCount; phaseI++)
 	{
-		return true;
+		const FrameStats::Phase phase = static_cast<FrameStats::Phase>(phaseI);
+		statsShown[phaseI] = frameStats.summarize(phase);
+		length += SDL_snprintf(title + length, sizeof(title) - length, " %s %.2f/%.2f/%.2f",
+			FrameStats::phaseName(phase), statsShown[phaseI].p50, statsShown[phaseI].p99, statsShown[phaseI].max);
 	}
-	return false;
+	SDL_snprintf(title + length, sizeof(title) - length, " ms (p50/p99/max)");
+	drawLists->back().title = title;
+	presentPending = true;
 }
 
-bool puzzleSolved()
+// One row of bars per phase, over a scale of two frame budgets with a tick at one budget.
+// Each row draws max, then p99, then p50 on top, each darker than the last.
+void drawStatsOverlay()
 {
-	for (auto obj : puzzlePiecesAll)
+	static const SDL_Color phaseColors[FrameStats::phaseCount] = {
+		{ 80, 160, 255, 255 }, { 90, 200, 110, 255 }, { 240, 170, 60, 255 }, { 220, 80, 200, 255 }, { 230, 230, 230, 255 },
+	};
+	const int barLeft = 8;
+	const int barTop = 8;
+	const int rowHeight = 12;
+	const int scaleWidth = 240;
+	const double pixelsPerMs = scaleWidth / (2.0 * fpsDelay);
+
+	std::vector<DrawCommand> &overlay = drawLists->back().overlay;
+	const SDL_Rect background = { barLeft - 4, barTop - 4, scaleWidth + 8, FrameStats::phaseCount * rowHeight + 6 };
+	overlay.push_back(DrawCommand::fill(-1, background, { 0, 0, 0, 160 }));
+
+	for (int phaseI = 0; phaseI < FrameStats::phaseCount; phaseI++)
 	{
-		if (obj.visState != puzzlePiece::VisState::SOLVED)
+		const FrameStats::summary &shown = statsShown[phaseI];
+		const double values[3] = { shown.max, shown.p99, shown.p50 };
+		const Uint8 alphas[3] = { 90, 170, 255 };
+		for (int barI = 0; barI < 3; barI++)
 		{
-			return false;
+			const int width = std::min(scaleWidth, static_cast<int>(values[barI] * pixelsPerMs + 0.5));
+			const SDL_Rect bar = { barLeft, barTop + phaseI * rowHeight, std::max(1, width), rowHeight - 3 };
+			const SDL_Color color = { phaseColors[phaseI].r, phaseColors[phaseI].g, phaseColors[phaseI].b, alphas[barI] };
+			overlay.push_back(DrawCommand::fill(-1, bar, color));
 		}
 	}
-	return true;
+	const SDL_Rect budget = { barLeft + scaleWidth / 2, barTop - 2, 1, FrameStats::phaseCount * rowHeight + 3 };
+	overlay.push_back(DrawCommand::fill(-1, budget, { 255, 60, 60, 255 }));
 }
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "pch.h"
+#include "PuzzleCache.h"
+#include "AssetIO.h"
+
+namespace
+{
+	size_t regionBytes(const AtlasRegion &region)
+	{
+		return static_cast<size_t>(region.rect.w) * region.rect.h * 4; // Atlas pages are always 32 bits per pixel.
+	}
+}
+
+PuzzleCache::PuzzleCache(TextureAtlas &atlas, SheetLoader &loader, const std::vector<std::string> &paths, int tileSize, int minTiles,
+	size_t budgetBytes)
+	: atlas(atlas), loader(loader), tileSize(tileSize), minTiles(minTiles), budgetBytes(budgetBytes), entries(paths.size())
+{
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		entries[i].path = paths[i];
+	}
+}
+
+AtlasRegion PuzzleCache::acquire(int puzzleI)
+{
+	cacheEntry &entry = entries[puzzleI];
+	if (entry.region.page >= 0)
+	{
+		counters.hits++;
+		touch(puzzleI);
+		return entry.region;
+	}
+
+	counters.misses++;
+	if (!entry.loading)
+	{
+		entry.loading = true;
+		loader.request(entry.path, puzzleI);
+	}
+	return AtlasRegion();
+}
+
+void PuzzleCache::upload(int puzzleI, SDL_Surface *surface)
+{
+	cacheEntry &entry = entries[puzzleI];
+	entry.loading = false;
+	const bool reloaded = entry.reloading;
+	entry.reloading = false;
+	if (surface == NULL || (entry.region.page >= 0 && !reloaded))
+	{
+		return;
+	}
+	const int tiles = (surface->w / tileSize) * (surface->h / tileSize);
+	if (tiles < minTiles)
+	{
+		SDL_Log("PuzzleCache: %s has %d pictures but the board needs %d", entry.path.c_str(), tiles, minTiles);
+		return;
+	}
+
+	if (entry.region.page >= 0)
+	{
+		if (atlas.replace(entry.region, surface))
+		{
+			return;
+		}
+		// The sheet changed size, so it needs a new home in the atlas.
+		atlas.release(entry.region);
+		counters.residentBytes -= regionBytes(entry.region);
+	}
+
+	entry.region = atlas.add(surface);
+	if (entry.region.page < 0)
+	{
+		SDL_Log("PuzzleCache: could not fit %s into the texture atlas", entry.path.c_str());
+		return;
+	}
+	counters.residentBytes += regionBytes(entry.region);
+	touch(puzzleI);
+	evictOverBudget();
+}
+
+void PuzzleCache::reload(int puzzleI)
+{
+	cacheEntry &entry = entries[puzzleI];
+	if (entry.region.page >= 0 && !entry.reloading)
+	{
+		entry.reloading = true;
+		loader.request(entry.path, puzzleI);
+	}
+}
+
+int PuzzleCache::find(const std::string &path) const
+{
+	const std::string name = AssetIO::normalizeName(path);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (AssetIO::normalizeName(entries[i].path) == name)
+		{
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+void PuzzleCache::touch(int puzzleI)
+{
+	cacheEntry &entry = entries[puzzleI];
+	if (entry.inLru)
+	{
+		lru.splice(lru.begin(), lru, entry.lruPos);
+	}
+	else
+	{
+		lru.push_front(puzzleI);
+		entry.inLru = true;
+	}
+	entry.lruPos = lru.begin();
+}
+
+void PuzzleCache::evictOverBudget()
+{
+	while (atlas.textureBytes() > budgetBytes)
+	{
+		// Per page: how many of its images are resident sheets, and the LRU rank of the newest of them.
+		// A page can only be emptied if every image on it is a sheet that may go, and never holds the
+		// pinned sheet or the one just touched (rank 0).
+		std::vector<int> sheetsOnPage(atlas.pageCount(), 0);
+		std::vector<int> newestRank(atlas.pageCount(), -1);
+		int pinnedPage = -1;
+		int rank = 0;
+		for (int puzzleI : lru)
+		{
+			const int page = entries[puzzleI].region.page;
+			sheetsOnPage[page]++;
+			if (newestRank[page] < 0)
+			{
+				newestRank[page] = rank;
+			}
+			if (puzzleI == pinnedPuzzle)
+			{
+				pinnedPage = page;
+			}
+			rank++;
+		}
+
+		int victimPage = -1;
+		for (int page = 0; page < atlas.pageCount(); page++)
+		{
+			if (page != pinnedPage && newestRank[page] > 0 && sheetsOnPage[page] == atlas.pageImages(page) &&
+				(victimPage < 0 || newestRank[page] > newestRank[victimPage]))
+			{
+				victimPage = page;
+			}
+		}
+		if (victimPage < 0)
+		{
+			return; // Everything left is in use or shares its page with something that is.
+		}
+
+		for (auto it = lru.begin(); it != lru.end();)
+		{
+			const int puzzleI = *it;
+			++it;
+			if (entries[puzzleI].region.page == victimPage)
+			{
+				evict(puzzleI);
+			}
+		}
+	}
+}
+
+void PuzzleCache::evict(int puzzleI)
+{
+	cacheEntry &entry = entries[puzzleI];
+	atlas.release(entry.region);
+	counters.residentBytes -= regionBytes(entry.region);
+	counters.evictions++;
+	entry.region = AtlasRegion();
+	entry.inLru = false;
+	lru.erase(entry.lruPos);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "SheetLoader.h"
+#include "TextureAtlas.h"
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+
+// Keeps the puzzle sheets that are actually being played resident in the atlas, and nothing else.
+// Sheets are decoded on demand through the SheetLoader the first time they are asked for. Once the
+// atlas pages take up more texture memory than the budget, whole pages are emptied, starting with the page
+// whose most recently used sheet is the oldest, since the atlas only gives memory back when a page drops
+// its last image. Memory use therefore depends on the budget rather than on how many sheets the library
+// holds. The budget covers whole pages, including pages shared with images the cache doesn't own (which
+// are never emptied), so it should leave room for at least a couple of them.
+// A sheet with fewer than minTiles whole tiles of tileSize is refused as if it had failed to load, so a
+// sheet that is too small for the board never becomes resident.
+class PuzzleCache
+{
+public:
+	struct cacheStats
+	{
+		int hits = 0;
+		int misses = 0;
+		int evictions = 0;
+		size_t residentBytes = 0; // Pixels of the resident sheets themselves, without the rest of their pages.
+	};
+
+	PuzzleCache(TextureAtlas &atlas, SheetLoader &loader, const std::vector<std::string> &paths, int tileSize, int minTiles,
+		size_t budgetBytes);
+
+	// Returns the sheet's region if it is resident and marks it most recently used.
+	// Otherwise starts loading it (if it isn't already on its way) and returns a region with page -1.
+	AtlasRegion acquire(int puzzleI);
+
+	// The pinned sheet is never evicted, whatever the budget says. Use it for the puzzle on screen.
+	void pin(int puzzleI) { pinnedPuzzle = puzzleI; }
+
+	// Called with sheets delivered by the SheetLoader; the tag is the puzzle index.
+	// A reloaded sheet is swapped into its existing region when it is still the same size.
+	// A reload that is too small for the board is dropped and the sheet keeps its old pixels.
+	void upload(int puzzleI, SDL_Surface *surface);
+
+	// Decodes a resident sheet again after its file changed. Sheets that aren't resident are left alone,
+	// since they will be read fresh the next time they are acquired.
+	void reload(int puzzleI);
+
+	// Returns the index of the sheet loaded from path, or -1.
+	int find(const std::string &path) const;
+
+	bool resident(int puzzleI) const { return entries[puzzleI].region.page >= 0; }
+	int puzzleCount() const { return static_cast<int>(entries.size()); }
+	const cacheStats &stats() const { return counters; }
+
+private:
+	struct cacheEntry
+	{
+		std::string path;
+		AtlasRegion region;
+		bool loading = false;
+		bool reloading = false;
+		bool inLru = false;
+		std::list<int>::iterator lruPos;
+	};
+
+	void touch(int puzzleI);
+	void evictOverBudget();
+	void evict(int puzzleI);
+
+	TextureAtlas &atlas;
+	SheetLoader &loader;
+	int tileSize;
+	int minTiles;
+	size_t budgetBytes;
+	std::vector<cacheEntry> entries;
+	std::list<int> lru; // Resident puzzle indices, most recently used first.
+	int pinnedPuzzle = -1;
+	cacheStats counters;
+};
@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "PuzzleManifest.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+	const char *manifestTag = "memoryflip-manifest";
+	const int manifestVersion = 2;
+
+	std::uint32_t readBigEndian32(const unsigned char *bytes)
+	{
+		return (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) | (std::uint32_t(bytes[2]) << 8) | bytes[3];
+	}
+}
+
+PuzzleManifest::PuzzleManifest(const std::string &manifestPath, const std::string &puzzlesDir, int tileSize)
+	: manifestPath(manifestPath), puzzlesDir(puzzlesDir), tileSize(tileSize)
+{
+}
+
+void PuzzleManifest::refresh()
+{
+	TraceSpan span("refresh puzzle manifest");
+	std::uint64_t dirSize = 0;
+	std::int64_t currentDirMtime = 0;
+	const bool dirFound = MappedFile::statFile(puzzlesDir, dirSize, currentDirMtime);
+	if (!load() || !dirFound || currentDirMtime != dirMtime)
+	{
+		rescan();
+		dirMtime = currentDirMtime;
+		dirty = true;
+	}
+
+	for (auto it = records.begin(); it != records.end();)
+	{
+		std::uint64_t size = 0;
+		std::int64_t mtime = 0;
+		if (!MappedFile::statFile(it->path, size, mtime))
+		{
+			it = records.erase(it);
+			dirty = true;
+			continue;
+		}
+		// Sheets that failed the probe stay listed, so fixing one in place is noticed here like any other edit.
+		if (size != it->size || mtime != it->mtime)
+		{
+			it->size = size;
+			it->mtime = mtime;
+			it->valid = probe(*it);
+			dirty = true;
+		}
+		++it;
+	}
+
+	if (dirty && save())
+	{
+		dirty = false;
+	}
+}
+
+bool PuzzleManifest::probe(sheetRecord &record) const
+{
+	// The PNG signature is followed by the IHDR chunk, which starts with the width and height: 24 bytes in all.
+	static const unsigned char pngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	unsigned char header[24];
+	std::ifstream in(record.path, std::ios::binary);
+	if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+		!std::equal(pngSignature, pngSignature + 8, header) || !std::equal(header + 12, header + 16, "IHDR"))
+	{
+		record.width = 0;
+		record.height = 0;
+		record.tileCount = 0;
+		return false;
+	}
+	record.width = static_cast<int>(readBigEndian32(header + 16));
+	record.height = static_cast<int>(readBigEndian32(header + 20));
+	record.tileCount = (record.width / tileSize) * (record.height / tileSize);
+	return true;
+}
+
+bool PuzzleManifest::load()
+{
+	std::ifstream in(manifestPath);
+	std::string line;
+	if (!in || !std::getline(in, line))
+	{
+		return false;
+	}
+
+	std::istringstream header(line);
+	std::string tag;
+	int version = 0;
+	int savedTileSize = 0;
+	header >> tag >> version >> savedTileSize >> dirMtime;
+	if (!header || tag != manifestTag || version != manifestVersion || savedTileSize != tileSize)
+	{
+		return false;
+	}
+
+	records.clear();
+	while (std::getline(in, line))
+	{
+		std::istringstream fields(line);
+		sheetRecord record;
+		std::getline(fields, record.path, '\t');
+		fields >> record.size >> record.mtime >> record.valid >> record.width >> record.height >> record.tileCount;
+		if (fields && !record.path.empty())
+		{
+			records.push_back(record);
+		}
+	}
+	return true;
+}
+
+bool PuzzleManifest::save() const
+{
+	std::ofstream out(manifestPath, std::ios::trunc);
+	out << manifestTag << '\t' << manifestVersion << '\t' << tileSize << '\t' << dirMtime << '\n';
+	for (const auto &record : records)
+	{
+		out << record.path << '\t' << record.size << '\t' << record.mtime << '\t' << record.valid << '\t'
+			<< record.width << '\t' << record.height << '\t' << record.tileCount << '\n';
+	}
+	return static_cast<bool>(out);
+}
+
+void PuzzleManifest::rescan()
+{
+	std::map<std::string, sheetRecord> known;
+	for (const auto &record : records)
+	{
+		known[record.path] = record;
+	}
+
+	std::vector<sheetRecord> scanned;
+	std::error_code ec;
+	for (auto& file : fs::directory_iterator(puzzlesDir, ec))
+	{
+		// Match the extension exactly, so backups like foo.png.bak are left alone.
+		if (!fs::is_regular_file(file.status()) || file.path().extension() != ".png")
+		{
+			continue;
+		}
+
+		sheetRecord record;
+		record.path = file.path().string();
+		// Known sheets keep their size and mtime, so the validation pass in refresh() leaves them alone if unchanged.
+		auto found = known.find(record.path);
+		scanned.push_back(found != known.end() ? found->second : record);
+	}
+	std::sort(scanned.begin(), scanned.end(), [](const sheetRecord &a, const sheetRecord &b) { return a.path < b.path; });
+	records.swap(scanned);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A record of every puzzle sheet in the puzzles directory, kept on disk between runs.
+// On startup the directory is only enumerated again if its own modification time moved on, and a sheet is
+// only re-read (probed for its size, which reads just its PNG header) if its file size or modification time changed.
+// Everything else comes straight from the manifest, so a large library on slow storage costs one stat per sheet.
+class PuzzleManifest
+{
+public:
+	struct sheetRecord
+	{
+		std::string path;
+		std::uint64_t size = 0;
+		std::int64_t mtime = 0;
+		bool valid = false; // False if the probe failed. The record is kept so the sheet is probed again once it changes.
+		int width = 0;
+		int height = 0;
+		int tileCount = 0; // Whole tiles of tileSize that fit in the sheet.
+	};
+
+	PuzzleManifest(const std::string &manifestPath, const std::string &puzzlesDir, int tileSize);
+
+	// Brings the manifest up to date with the directory and writes it back out if anything changed.
+	void refresh();
+
+	// Every sheet in the directory, including ones whose probe failed (valid is false).
+	const std::vector<sheetRecord> &sheets() const { return records; }
+
+	// Reads the PNG header to fill in the record's dimensions. Returns false if it isn't a PNG.
+	bool probe(sheetRecord &record) const;
+
+private:
+	bool load();
+	bool save() const;
+	void rescan();
+
+	std::string manifestPath;
+	std::string puzzlesDir;
+	int tileSize;
+	std::int64_t dirMtime = 0;
+	std::vector<sheetRecord> records;
+	bool dirty = false;
+};
@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "PuzzlePack.h"
+#include "AssetIO.h"
+#include <SDL_image.h>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	const std::uint64_t pixelAlignment = 16;
+
+	std::uint64_t alignUp(std::uint64_t value)
+	{
+		return (value + pixelAlignment - 1) & ~(pixelAlignment - 1);
+	}
+}
+
+bool PuzzlePack::open(const std::string &path)
+{
+	if (!file.open(path))
+	{
+		return false;
+	}
+
+	const bool valid = file.size() >= sizeof(packHeader) &&
+		header().magic == magic &&
+		header().version == version &&
+		SDL_BYTESPERPIXEL(header().pixelFormat) == 4 &&
+		file.size() >= sizeof(packHeader) + static_cast<size_t>(header().entryCount) * sizeof(packEntry);
+	if (!valid)
+	{
+		SDL_Log("PuzzlePack: %s is not a version %u pack", path.c_str(), version);
+		file.close();
+		return false;
+	}
+
+	for (int i = 0; i < entryCount(); i++)
+	{
+		const packEntry &packed = entry(i);
+		if (packed.offset + static_cast<std::uint64_t>(packed.width) * packed.height * 4 > file.size())
+		{
+			SDL_Log("PuzzlePack: %s is truncated", path.c_str());
+			file.close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void PuzzlePack::registerWith(AssetIO &io) const
+{
+	for (int i = 0; i < entryCount(); i++)
+	{
+		const packEntry &packed = entry(i);
+		if (!current(packed))
+		{
+			SDL_Log("PuzzlePack: %s changed since the pack was built, reading the file instead (rebuild with --build-pack)", packed.name);
+			continue;
+		}
+		const AssetIO::decodedImage decoded = {
+			static_cast<int>(packed.width), static_cast<int>(packed.height), static_cast<int>(packed.width) * 4, header().pixelFormat };
+		io.registerMemory(packed.name, file.data() + packed.offset, static_cast<size_t>(packed.height) * decoded.pitch, &decoded);
+	}
+}
+
+bool PuzzlePack::current(const packEntry &packed)
+{
+	std::uint64_t size = 0;
+	std::int64_t mtime = 0;
+	if (!MappedFile::statFile(packed.name, size, mtime))
+	{
+		return true; // Shipped without the loose files.
+	}
+	return size == packed.sourceSize && mtime == packed.sourceMtime;
+}
+
+bool PuzzlePack::build(const std::string &outPath, const std::vector<std::string> &sources, int tileSize, Uint32 pixelFormat)
+{
+	std::vector<packEntry> table;
+	std::vector<SDL_Surface *> images;
+	for (const auto &source : sources)
+	{
+		const std::string name = AssetIO::normalizeName(source);
+		if (name.size() >= nameLength)
+		{
+			SDL_Log("PuzzlePack: skipping %s, the name is too long for a pack", source.c_str());
+			continue;
+		}
+		SDL_Surface *loaded = IMG_Load_RW(AssetIO::mapFile(source), 1);
+		SDL_Surface *converted = loaded ? SDL_ConvertSurfaceFormat(loaded, pixelFormat, 0) : NULL;
+		SDL_FreeSurface(loaded);
+		if (converted == NULL)
+		{
+			SDL_Log("PuzzlePack: skipping %s: %s", source.c_str(), SDL_GetError());
+			continue;
+		}
+
+		packEntry packed = {};
+		std::strncpy(packed.name, name.c_str(), nameLength - 1);
+		packed.width = converted->w;
+		packed.height = converted->h;
+		packed.tileSize = tileSize;
+		packed.tileCount = (converted->w / tileSize) * (converted->h / tileSize);
+		MappedFile::statFile(source, packed.sourceSize, packed.sourceMtime);
+		table.push_back(packed);
+		images.push_back(converted);
+	}
+
+	std::uint64_t offset = alignUp(sizeof(packHeader) + table.size() * sizeof(packEntry));
+	for (auto &packed : table)
+	{
+		packed.offset = offset;
+		offset = alignUp(offset + static_cast<std::uint64_t>(packed.width) * packed.height * 4);
+	}
+
+	std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+	packHeader head = { magic, version, pixelFormat, static_cast<std::uint32_t>(table.size()) };
+	out.write(reinterpret_cast<const char *>(&head), sizeof(head));
+	out.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(packEntry));
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		const std::vector<char> zeros(pixelAlignment, 0);
+		out.write(zeros.data(), static_cast<std::streamsize>(table[i].offset - static_cast<std::uint64_t>(out.tellp())));
+
+		SDL_Surface *image = images[i];
+		SDL_LockSurface(image);
+		for (int row = 0; row < image->h; row++)
+		{
+			out.write(static_cast<const char *>(image->pixels) + row * image->pitch, image->w * 4);
+		}
+		SDL_UnlockSurface(image);
+		SDL_FreeSurface(image);
+	}
+
+	if (!out)
+	{
+		SDL_Log("PuzzlePack: could not write %s", outPath.c_str());
+		return false;
+	}
+	SDL_Log("PuzzlePack: wrote %u images to %s", static_cast<unsigned>(table.size()), outPath.c_str());
+	return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "AssetIO.h"
+#include "MappedFile.h"
+#include <SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A pack of images that have already been decoded, stored in the pixel format the atlas keeps its pages in.
+// The pack is memory-mapped and its images are registered with AssetIO, which hands each one out as a surface that
+// points straight into the mapping, so loading an image from a pack does no inflating and no unfiltering. Its pixels are copied
+// once, when TextureAtlas queues them for the main thread to upload.
+//
+// Layout (little-endian):
+//   packHeader
+//   packEntry[entryCount]
+//   pixel data for each entry, tightly packed rows, each image starting on a 16 byte boundary
+//
+// Each entry remembers the size and modification time its source file had when the pack was built. A source that
+// has changed since is read from disk instead, so editing a PNG works the same with or without a pack.
+class PuzzlePack
+{
+public:
+	static const std::uint32_t magic = 0x4B50464D; // "MFPK"
+	static const std::uint32_t version = 2;
+	static const int nameLength = 96;
+
+	struct packHeader
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t pixelFormat; // An SDL_PixelFormatEnum value, 32 bits per pixel.
+		std::uint32_t entryCount;
+	};
+
+	struct packEntry
+	{
+		char name[nameLength]; // Asset path relative to the game directory, with '/' separators.
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t tileSize; // Edge length of a square puzzle tile in pixels.
+		std::uint32_t tileCount; // Whole tiles that fit in the image.
+		std::uint64_t offset; // Byte offset of the pixel data from the start of the pack.
+		std::uint64_t sourceSize; // The source file as it was when the pack was built.
+		std::int64_t sourceMtime;
+	};
+
+	bool open(const std::string &path);
+	bool isOpen() const { return file.isOpen(); }
+
+	// Registers every entry with io as a decoded image inside the mapping, so loading it does no decoding at all.
+	// Entries whose source file changed since the pack was built are left out, and io reads the file instead.
+	// The pack must stay open as long as io serves its entries.
+	void registerWith(AssetIO &io) const;
+
+	// Whether the entry's source file, if there is one, still has the size and modification time it was packed with.
+	// A source that is missing altogether doesn't count as changed.
+	static bool current(const packEntry &packed);
+	const packEntry &entry(int i) const { return entries()[i]; }
+	int entryCount() const { return isOpen() ? static_cast<int>(header().entryCount) : 0; }
+
+	// Decodes the sources and writes them out as a pack in pixelFormat. Used by the --build-pack command.
+	static bool build(const std::string &outPath, const std::vector<std::string> &sources, int tileSize, Uint32 pixelFormat);
+
+private:
+	const packHeader &header() const { return *reinterpret_cast<const packHeader *>(file.data()); }
+	const packEntry *entries() const { return reinterpret_cast<const packEntry *>(file.data() + sizeof(packHeader)); }
+
+	MappedFile file;
+};
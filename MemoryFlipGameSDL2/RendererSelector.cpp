@@ -0,0 +1,183 @@
+#include "pch.h"
+#include "RendererSelector.h"
+#include "SdlDestructors.h"
+#include "Trace.h"
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	const char *cacheTag = "memoryflip-renderer";
+	const int cacheVersion = 1;
+
+	// Roughly one frame of the default board: a hundred 40px tiles, each with an outline, onto a 600x600 target.
+	const int benchTiles = 100;
+	const int benchTileSize = 40;
+	const int benchTargetSize = 600;
+	const int benchWarmupFrames = 3;
+	const int benchFrames = 20;
+
+	int driverIndex(const std::string &name)
+	{
+		for (int driverI = 0; driverI < SDL_GetNumRenderDrivers(); driverI++)
+		{
+			SDL_RendererInfo info;
+			if (SDL_GetRenderDriverInfo(driverI, &info) == 0 && name == info.name)
+			{
+				return driverI;
+			}
+		}
+		return -1;
+	}
+}
+
+int RendererSelector::choose(SDL_Window *window, const std::string &cachePath)
+{
+	if (SDL_GetHint(SDL_HINT_RENDER_DRIVER) != NULL)
+	{
+		return -1;
+	}
+
+	const std::string drivers = driverList();
+	{
+		std::ifstream in(cachePath);
+		std::string line;
+		std::getline(in, line);
+		std::istringstream fields(line);
+		std::string tag;
+		std::string version;
+		std::string cachedDrivers;
+		std::string chosen;
+		std::getline(fields, tag, '\t');
+		std::getline(fields, version, '\t');
+		std::getline(fields, cachedDrivers, '\t');
+		std::getline(fields, chosen);
+		if (tag == cacheTag && SDL_atoi(version.c_str()) == cacheVersion && cachedDrivers == drivers)
+		{
+			const int driverI = driverIndex(chosen);
+			if (driverI >= 0)
+			{
+				SDL_Log("RendererSelector: using cached choice %s", chosen.c_str());
+				return driverI;
+			}
+		}
+	}
+
+	TraceSpan span("probe render drivers");
+	int bestDriver = -1;
+	double bestMs = 0.0;
+	std::string bestName;
+	for (int driverI = 0; driverI < SDL_GetNumRenderDrivers(); driverI++)
+	{
+		SDL_RendererInfo info;
+		if (SDL_GetRenderDriverInfo(driverI, &info) != 0)
+		{
+			continue;
+		}
+		const double ms = benchmark(window, driverI);
+		if (ms < 0.0)
+		{
+			SDL_Log("RendererSelector: %s is not usable", info.name);
+		}
+		else
+		{
+			SDL_Log("RendererSelector: %s drew the benchmark in %.1f ms", info.name, ms);
+		}
+		if (ms >= 0.0 && (bestDriver < 0 || ms < bestMs))
+		{
+			bestDriver = driverI;
+			bestMs = ms;
+			bestName = info.name;
+		}
+	}
+
+	if (bestDriver >= 0)
+	{
+		std::ofstream out(cachePath, std::ios::trunc);
+		out << cacheTag << '\t' << cacheVersion << '\t' << drivers << '\t' << bestName << '\n';
+		SDL_Log("RendererSelector: picked %s", bestName.c_str());
+	}
+	return bestDriver;
+}
+
+double RendererSelector::benchmark(SDL_Window *window, int driverI)
+{
+	SDL_RendererInfo info;
+	if (SDL_GetRenderDriverInfo(driverI, &info) != 0 || (info.flags & SDL_RENDERER_TARGETTEXTURE) == 0)
+	{
+		return -1.0;
+	}
+
+	std::unique_ptr<SDL_Renderer, sdlDestructorRenderer> renderer(SDL_CreateRenderer(window, driverI, SDL_RENDERER_TARGETTEXTURE));
+	if (!renderer)
+	{
+		return -1.0;
+	}
+
+	// A stand-in atlas page with some pixels in it, and a board target like the game's.
+	const int atlasSize = benchTileSize * 8;
+	std::unique_ptr<SDL_Texture, sdlDestructorTexture> atlas(
+		SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, atlasSize, atlasSize));
+	std::unique_ptr<SDL_Texture, sdlDestructorTexture> target(
+		SDL_CreateTexture(renderer.get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, benchTargetSize, benchTargetSize));
+	if (!atlas || !target)
+	{
+		return -1.0;
+	}
+	std::vector<Uint32> pixels(atlasSize * atlasSize);
+	for (size_t pixelI = 0; pixelI < pixels.size(); pixelI++)
+	{
+		pixels[pixelI] = 0x80000000u | static_cast<Uint32>(pixelI * 2654435761u >> 8);
+	}
+	SDL_UpdateTexture(atlas.get(), NULL, pixels.data(), atlasSize * sizeof(Uint32));
+	SDL_SetTextureBlendMode(atlas.get(), SDL_BLENDMODE_BLEND);
+	SDL_SetTextureBlendMode(target.get(), SDL_BLENDMODE_NONE);
+
+	const int tilesPerRow = benchTargetSize / (benchTileSize + 5);
+	Uint64 begin = 0;
+	for (int frameI = 0; frameI < benchWarmupFrames + benchFrames; frameI++)
+	{
+		if (frameI == benchWarmupFrames)
+		{
+			begin = SDL_GetPerformanceCounter();
+		}
+		SDL_SetRenderTarget(renderer.get(), target.get());
+		SDL_SetRenderDrawColor(renderer.get(), 242, 242, 242, 255);
+		SDL_RenderClear(renderer.get());
+		for (int tileI = 0; tileI < benchTiles; tileI++)
+		{
+			const SDL_Rect src = { ((tileI + frameI) % 8) * benchTileSize, (tileI / 8 % 8) * benchTileSize, benchTileSize, benchTileSize };
+			const SDL_Rect outline = { 0, 0, benchTileSize, benchTileSize };
+			const SDL_Rect dst = { (tileI % tilesPerRow) * (benchTileSize + 5), (tileI / tilesPerRow) * (benchTileSize + 5), benchTileSize, benchTileSize };
+			SDL_RenderFillRect(renderer.get(), &dst);
+			SDL_RenderCopy(renderer.get(), atlas.get(), &src, &dst);
+			SDL_RenderCopy(renderer.get(), atlas.get(), &outline, &dst);
+		}
+		SDL_SetRenderTarget(renderer.get(), NULL);
+		SDL_RenderCopy(renderer.get(), target.get(), NULL, NULL);
+		SDL_RenderPresent(renderer.get());
+	}
+	// Reading a pixel back waits for the GPU to finish, so queued work isn't mistaken for speed.
+	Uint32 pixel = 0;
+	const SDL_Rect one = { 0, 0, 1, 1 };
+	SDL_RenderReadPixels(renderer.get(), &one, SDL_PIXELFORMAT_ARGB8888, &pixel, sizeof(pixel));
+	return (SDL_GetPerformanceCounter() - begin) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+// Driver names in SDL's order, plus the video driver, which decides what they actually run on.
+std::string RendererSelector::driverList()
+{
+	std::string list = SDL_GetCurrentVideoDriver() ? SDL_GetCurrentVideoDriver() : "";
+	for (int driverI = 0; driverI < SDL_GetNumRenderDrivers(); driverI++)
+	{
+		SDL_RendererInfo info;
+		if (SDL_GetRenderDriverInfo(driverI, &info) == 0)
+		{
+			list += ',';
+			list += info.name;
+		}
+	}
+	return list;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+
+// Picks the render driver that draws a board fastest on this machine, rather than whichever one SDL lists first.
+// Each driver that can render to textures is timed drawing a board's worth of tiles into a target and presenting it.
+// The winner is cached together with the video driver and SDL's list of render drivers, so later launches skip the
+// probe until those change, e.g. with a different SDL build or video backend. A GPU or graphics driver update changes
+// neither, so delete the cache file to probe again after one.
+class RendererSelector
+{
+public:
+	// Returns the driver index to pass to SDL_CreateRenderer, or -1 to leave the choice to SDL.
+	// SDL's own SDL_RENDER_DRIVER hint, if set, always wins and nothing is probed.
+	// The window should still be hidden, since every candidate renders into it.
+	static int choose(SDL_Window *window, const std::string &cachePath);
+
+private:
+	// Milliseconds to draw the benchmark frames, or a negative number if the driver can't be used.
+	static double benchmark(SDL_Window *window, int driverI);
+	static std::string driverList();
+};
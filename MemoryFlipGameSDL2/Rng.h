@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+// PCG32 (XSH-RR): 64-bit state, 32-bit output. Small enough to copy around by value and fast enough to deal thousands of boards.
+// Everything is defined in terms of fixed-width integer arithmetic, so a seed produces the same sequence on every
+// platform and compiler. Nothing here goes through <random>'s distributions, whose output differs between standard libraries.
+// It also meets UniformRandomBitGenerator, so it can stand in wherever a standard engine was used.
+class Pcg32
+{
+public:
+	using result_type = std::uint32_t;
+
+	// Both the state and the stream are derived from seed through SplitMix64, so neighbouring seeds give unrelated sequences.
+	explicit Pcg32(std::uint64_t seed)
+	{
+		std::uint64_t mix = seed;
+		const std::uint64_t initState = splitMix64(mix);
+		increment = (splitMix64(mix) << 1) | 1;
+		state = 0;
+		next();
+		state += initState;
+		next();
+	}
+
+	std::uint32_t next()
+	{
+		const std::uint64_t old = state;
+		state = old * 6364136223846793005ULL + increment;
+		const std::uint32_t xorShifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+		const std::uint32_t rot = static_cast<std::uint32_t>(old >> 59);
+		return (xorShifted >> rot) | (xorShifted << ((32 - rot) & 31));
+	}
+
+	// Uniform in [0, bound), without modulo bias (Lemire's multiply-and-reject).
+	std::uint32_t bounded(std::uint32_t bound)
+	{
+		std::uint64_t product = std::uint64_t(next()) * bound;
+		std::uint32_t low = static_cast<std::uint32_t>(product);
+		if (low < bound)
+		{
+			const std::uint32_t threshold = (0u - bound) % bound;
+			while (low < threshold)
+			{
+				product = std::uint64_t(next()) * bound;
+				low = static_cast<std::uint32_t>(product);
+			}
+		}
+		return static_cast<std::uint32_t>(product >> 32);
+	}
+
+	result_type operator()() { return next(); }
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT32_MAX; }
+
+private:
+	static std::uint64_t splitMix64(std::uint64_t &x)
+	{
+		std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	std::uint64_t state;
+	std::uint64_t increment;
+};
+
+// The generator the game deals boards with. Swap it here; BoardGenerator only needs next() and bounded().
+using Rng = Pcg32;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SDL.h>
+
+// Deleters so SDL objects can be owned by std::unique_ptr.
+
+struct sdlDestructorWindow
+{
+	void operator()(SDL_Window *window) const
+	{
+		SDL_DestroyWindow(window);
+		SDL_Log("SDL_Window deleted");
+	}
+};
+
+struct sdlDestructorRenderer
+{
+	void operator()(SDL_Renderer *renderer) const
+	{
+		SDL_DestroyRenderer(renderer);
+		SDL_Log("SDL_Renderer deleted");
+	}
+};
+
+struct sdlDestructorTexture
+{
+	void operator()(SDL_Texture *texture) const
+	{
+		SDL_DestroyTexture(texture);
+		SDL_Log("SDL_Texture deleted");
+	}
+};
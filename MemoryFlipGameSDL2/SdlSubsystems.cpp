@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "SdlSubsystems.h"
+#include "Trace.h"
+#include <vector>
+
+namespace
+{
+	struct bringUp
+	{
+		const char *name;
+		double ms;
+	};
+
+	std::vector<bringUp> bringUps;
+}
+
+bool SdlSubsystems::require(Uint32 flags, const char *name)
+{
+	const Uint32 missing = flags & ~SDL_WasInit(flags);
+	if (missing == 0)
+	{
+		return true;
+	}
+
+	TraceSpan span("SDL_InitSubSystem");
+	const Uint64 begin = SDL_GetPerformanceCounter();
+	const int result = SDL_InitSubSystem(missing);
+	const double ms = (SDL_GetPerformanceCounter() - begin) * 1000.0 / SDL_GetPerformanceFrequency();
+	bringUps.push_back({ name, ms });
+	if (result != 0)
+	{
+		SDL_Log("SdlSubsystems: could not initialise %s: %s", name, SDL_GetError());
+		return false;
+	}
+	return true;
+}
+
+void SdlSubsystems::logReport()
+{
+	for (const auto &entry : bringUps)
+	{
+		SDL_Log("Startup: %s subsystem took %.1f ms", entry.name, entry.ms);
+	}
+}
+
+double SdlSubsystems::totalMs()
+{
+	double total = 0.0;
+	for (const auto &entry : bringUps)
+	{
+		total += entry.ms;
+	}
+	return total;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SDL.h>
+
+// Brings SDL subsystems up one at a time, when the feature that needs them first asks, instead of SDL_INIT_EVERYTHING.
+// Audio, joystick, haptic and game controller probing can take hundreds of milliseconds on some machines,
+// and the game uses none of them. Each bring-up is timed, so startup can report where its time went.
+class SdlSubsystems
+{
+public:
+	// Initialises the subsystems in flags that aren't up yet. name labels the time in the report.
+	// Returns false (and logs SDL's error) if SDL could not initialise them.
+	static bool require(Uint32 flags, const char *name);
+
+	// Logs the time spent bringing up each subsystem so far.
+	static void logReport();
+
+	// Total ms spent in require().
+	static double totalMs();
+};
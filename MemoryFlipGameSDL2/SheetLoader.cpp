@@ -0,0 +1,119 @@
+#include "pch.h"
+#include "SheetLoader.h"
+#include "Trace.h"
+#include <SDL_image.h>
+#include <algorithm>
+
+SheetLoader::SheetLoader(const AssetIO &io, int workerCount)
+	: io(io)
+{
+	// SDL_image initialises its PNG loader lazily and without a lock, so make sure that has happened before any worker decodes.
+	IMG_Init(IMG_INIT_PNG);
+
+	if (workerCount <= 0)
+	{
+		workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+	for (int i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back(&SheetLoader::workerLoop, this);
+	}
+}
+
+SheetLoader::~SheetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	for (auto& done : decoded)
+	{
+		SDL_FreeSurface(done.surface);
+	}
+}
+
+void SheetLoader::request(const std::string &path, int tag)
+{
+	if (SDL_Surface *surface = io.openDecoded(path))
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			decoded.push_back({ path, tag, surface });
+			outstanding++;
+		}
+		jobDone.notify_all();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued.push_back({ path, tag, NULL });
+		outstanding++;
+	}
+	jobAvailable.notify_one();
+}
+
+void SheetLoader::deliver(const deliverFunc &fn, bool wait)
+{
+	std::deque<job> ready;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (wait)
+		{
+			jobDone.wait(lock, [this] { return !decoded.empty() || outstanding == 0; });
+		}
+		ready.swap(decoded);
+		outstanding -= static_cast<int>(ready.size());
+	}
+
+	for (auto& done : ready)
+	{
+		fn(done.tag, done.surface);
+		SDL_FreeSurface(done.surface);
+	}
+}
+
+bool SheetLoader::busy() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return outstanding > 0;
+}
+
+void SheetLoader::workerLoop()
+{
+	Trace::nameThread("sheet loader");
+	for (;;)
+	{
+		job current;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this] { return stopping || !queued.empty(); });
+			if (stopping)
+			{
+				return;
+			}
+			current = queued.front();
+			queued.pop_front();
+		}
+
+		{
+			TraceSpan span("decode sheet");
+			current.surface = IMG_Load_RW(io.open(current.path), 1);
+		}
+		if (current.surface == NULL)
+		{
+			SDL_Log("SheetLoader: could not decode %s: %s", current.path.c_str(), IMG_GetError());
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			decoded.push_back(current);
+		}
+		jobDone.notify_all();
+	}
+}
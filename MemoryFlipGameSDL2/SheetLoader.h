@@ -0,0 +1,62 @@
+#pragma once
+
+#include "AssetIO.h"
+#include <SDL.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decodes image files on a pool of worker threads.
+// Only the decode happens on the workers: decoded surfaces are queued up and handed back by deliver(), which the
+// game thread calls to pack them into the atlas (the upload itself happens on the main thread, which owns the renderer).
+// Requests are decoded in the order they were made, so the sheet needed first should be requested first.
+// Paths that AssetIO serves as decoded images (the members of a PuzzlePack) skip the workers entirely, since there
+// is nothing to decode.
+class SheetLoader
+{
+public:
+	// Called on the thread that calls deliver() with the tag given to request() and the decoded surface, or NULL if decoding failed.
+	// The surface is freed once the callback returns.
+	typedef std::function<void(int tag, SDL_Surface *surface)> deliverFunc;
+
+	// Files are read through io, which must outlive the loader. A workerCount of 0 uses one worker per hardware thread.
+	explicit SheetLoader(const AssetIO &io, int workerCount = 0);
+	~SheetLoader();
+
+	SheetLoader(const SheetLoader &) = delete;
+	SheetLoader &operator=(const SheetLoader &) = delete;
+
+	void request(const std::string &path, int tag);
+
+	// Hands every decoded surface to fn. If wait is true and nothing is ready yet,
+	// blocks until at least one request finishes (or returns at once if none are outstanding).
+	void deliver(const deliverFunc &fn, bool wait = false);
+
+	// True while any request has not yet been delivered.
+	bool busy() const;
+
+private:
+	struct job
+	{
+		std::string path;
+		int tag;
+		SDL_Surface *surface;
+	};
+
+	void workerLoop();
+
+	const AssetIO &io;
+
+	mutable std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobDone;
+	std::deque<job> queued;
+	std::deque<job> decoded;
+	int outstanding = 0; // Requested but not yet delivered.
+	bool stopping = false;
+	std::vector<std::thread> workers;
+};
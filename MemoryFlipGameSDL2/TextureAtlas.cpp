@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "TextureAtlas.h"
+#include <algorithm>
+
+TextureAtlas::TextureAtlas(SDL_Renderer *renderer, int pageSize)
+	: renderer(renderer), pageSize(pageSize)
+{
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info) == 0)
+	{
+		if (info.max_texture_width > 0 && info.max_texture_height > 0)
+		{
+			maxTextureWidth = info.max_texture_width;
+			maxTextureHeight = info.max_texture_height;
+			this->pageSize = std::min(pageSize, std::min(info.max_texture_width, info.max_texture_height));
+		}
+		// Prefer ARGB8888, which every stock SDL renderer stores natively, otherwise the renderer's first 32-bit format.
+		const Uint32 *formatsBegin = info.texture_formats;
+		const Uint32 *formatsEnd = formatsBegin + info.num_texture_formats;
+		if (std::find(formatsBegin, formatsEnd, SDL_PIXELFORMAT_ARGB8888) == formatsEnd)
+		{
+			auto native = std::find_if(formatsBegin, formatsEnd, [](Uint32 format)
+			{
+				return SDL_BYTESPERPIXEL(format) == 4 && SDL_ISPIXELFORMAT_ALPHA(format);
+			});
+			if (native != formatsEnd)
+			{
+				pixelFormat = *native;
+			}
+		}
+	}
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	// SDL_FreeSurface ignores the NULL pixels of page changes.
+	for (const pendingUpload &pending : uploads)
+	{
+		SDL_FreeSurface(pending.pixels);
+	}
+	for (const pendingUpload &pending : uploading)
+	{
+		SDL_FreeSurface(pending.pixels);
+	}
+}
+
+AtlasRegion TextureAtlas::add(SDL_Surface *surface)
+{
+	AtlasRegion region;
+	if (surface == NULL)
+	{
+		return region;
+	}
+
+	const int w = surface->w;
+	const int h = surface->h;
+	if (!reuse(w, h, region))
+	{
+		for (region.page = 0; region.page < pageCount(); region.page++)
+		{
+			if (pages[region.page].width > 0 && place(pages[region.page], w, h, region.rect))
+			{
+				break;
+			}
+		}
+		if (region.page == pageCount())
+		{
+			// Images bigger than a page get a page of their own.
+			region.page = addPage(std::max(pageSize, w + padding), std::max(pageSize, h + padding));
+			if (region.page < 0 || !place(pages[region.page], w, h, region.rect))
+			{
+				return AtlasRegion();
+			}
+		}
+	}
+	pages[region.page].images++;
+
+	if (!upload(region.page, region.rect, surface))
+	{
+		release(region);
+		return AtlasRegion();
+	}
+	return region;
+}
+
+bool TextureAtlas::replace(const AtlasRegion &region, SDL_Surface *surface)
+{
+	if (region.page < 0 || surface == NULL || surface->w != region.rect.w || surface->h != region.rect.h)
+	{
+		return false;
+	}
+	return upload(region.page, region.rect, surface);
+}
+
+bool TextureAtlas::upload(int page, const SDL_Rect &rect, SDL_Surface *surface)
+{
+	// Always a copy, even in the right format: the caller frees its surface long before the renderer's thread gets to it.
+	SDL_Surface *pixels = SDL_ConvertSurfaceFormat(surface, pixelFormat, 0);
+	if (pixels == NULL)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(queueMutex);
+	uploads.push_back({ page, rect, pixels });
+	return true;
+}
+
+void TextureAtlas::flushUploads()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		uploading.swap(uploads);
+	}
+	for (const pendingUpload &pending : uploading)
+	{
+		if (pending.pixels == NULL)
+		{
+			setPage(pending.page, pending.rect.w, pending.rect.h);
+			continue;
+		}
+		if (SDL_Texture *page = texture(pending.page))
+		{
+			SDL_UpdateTexture(page, &pending.rect, pending.pixels->pixels, pending.pixels->pitch);
+		}
+		SDL_FreeSurface(pending.pixels);
+	}
+	uploading.clear();
+}
+
+void TextureAtlas::release(const AtlasRegion &region)
+{
+	if (region.page < 0)
+	{
+		return;
+	}
+	if (--pages[region.page].images == 0)
+	{
+		dropPage(region.page);
+		return;
+	}
+	freeRegions.push_back(region);
+}
+
+bool TextureAtlas::reuse(int w, int h, AtlasRegion &region)
+{
+	// Best fit: the smallest free region the image fits in, which keeps the big ones for big images.
+	auto best = freeRegions.end();
+	for (auto freed = freeRegions.begin(); freed != freeRegions.end(); ++freed)
+	{
+		if (freed->rect.w >= w && freed->rect.h >= h &&
+			(best == freeRegions.end() || freed->rect.w * freed->rect.h < best->rect.w * best->rect.h))
+		{
+			best = freed;
+		}
+	}
+	if (best == freeRegions.end())
+	{
+		return false;
+	}
+
+	const AtlasRegion freed = *best;
+	freeRegions.erase(best);
+	region.page = freed.page;
+	region.rect = { freed.rect.x, freed.rect.y, w, h };
+
+	// Free what is left to the right of the image and below it. Each keeps the padding at its own top left.
+	const SDL_Rect right = { freed.rect.x + w + padding, freed.rect.y, freed.rect.w - w - padding, h };
+	const SDL_Rect below = { freed.rect.x, freed.rect.y + h + padding, freed.rect.w, freed.rect.h - h - padding };
+	if (right.w > 0 && right.h > 0)
+	{
+		freeRegions.push_back({ freed.page, right });
+	}
+	if (below.w > 0 && below.h > 0)
+	{
+		freeRegions.push_back({ freed.page, below });
+	}
+	return true;
+}
+
+bool TextureAtlas::place(atlasPage &page, int w, int h, SDL_Rect &rect)
+{
+	if (page.cursorX + w + padding > page.width)
+	{
+		// Start a new shelf under the current one.
+		page.shelfY += page.shelfHeight;
+		page.shelfHeight = 0;
+		page.cursorX = 0;
+	}
+	if (page.cursorX + w + padding > page.width || page.shelfY + h + padding > page.height)
+	{
+		return false;
+	}
+
+	rect = { page.cursorX + padding, page.shelfY + padding, w, h };
+	page.cursorX += w + padding;
+	page.shelfHeight = std::max(page.shelfHeight, h + padding);
+	return true;
+}
+
+int TextureAtlas::addPage(int width, int height)
+{
+	if ((maxTextureWidth > 0 && width > maxTextureWidth) || (maxTextureHeight > 0 && height > maxTextureHeight))
+	{
+		SDL_Log("TextureAtlas: a %dx%d page is bigger than the renderer allows", width, height);
+		return -1;
+	}
+
+	// Take over the slot of a dropped page if there is one, so page numbers stay small.
+	int pageI = 0;
+	while (pageI < pageCount() && pages[pageI].width > 0)
+	{
+		pageI++;
+	}
+	if (pageI == pageCount())
+	{
+		pages.emplace_back();
+	}
+	pages[pageI] = atlasPage();
+	pages[pageI].width = width;
+	pages[pageI].height = height;
+	pageBytes += static_cast<size_t>(width) * height * SDL_BYTESPERPIXEL(pixelFormat);
+	queuePageChange(pageI, width, height);
+	return pageI;
+}
+
+void TextureAtlas::dropPage(int pageI)
+{
+	freeRegions.erase(std::remove_if(freeRegions.begin(), freeRegions.end(), [pageI](const AtlasRegion &freed)
+	{
+		return freed.page == pageI;
+	}), freeRegions.end());
+	atlasPage &page = pages[pageI];
+	pageBytes -= static_cast<size_t>(page.width) * page.height * SDL_BYTESPERPIXEL(pixelFormat);
+	page = atlasPage();
+	queuePageChange(pageI, 0, 0);
+}
+
+void TextureAtlas::queuePageChange(int pageI, int width, int height)
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	uploads.push_back({ pageI, { 0, 0, width, height }, NULL });
+}
+
+void TextureAtlas::setPage(int pageI, int width, int height)
+{
+	if (pageI >= static_cast<int>(textures.size()))
+	{
+		textures.resize(pageI + 1);
+	}
+	textures[pageI].reset();
+	if (width == 0)
+	{
+		return;
+	}
+
+	std::unique_ptr<SDL_Texture, sdlDestructorTexture> page(
+		SDL_CreateTexture(renderer, pixelFormat, SDL_TEXTUREACCESS_STATIC, width, height));
+	if (page)
+	{
+		SDL_SetTextureBlendMode(page.get(), SDL_BLENDMODE_BLEND);
+
+		// Start fully transparent so the padding between images is well defined.
+		std::vector<Uint32> blank(static_cast<size_t>(width) * height, 0);
+		SDL_UpdateTexture(page.get(), NULL, blank.data(), width * sizeof(Uint32));
+	}
+	else
+	{
+		SDL_Log("TextureAtlas: could not create %dx%d page: %s", width, height, SDL_GetError());
+	}
+	textures[pageI] = std::move(page);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "SdlDestructors.h"
+#include <SDL.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Where an image ended up inside the atlas.
+struct AtlasRegion
+{
+	int page = -1; // -1 if the image could not be placed.
+	SDL_Rect rect = { 0, 0, 0, 0 };
+};
+
+// Packs many small images into a few large textures so the board can be drawn without switching textures.
+// Images are placed on shelves (rows as tall as their tallest image) and uploaded straight into the page
+// texture with SDL_UpdateTexture, so adding an image never re-uploads the rest of the page.
+// A released region is handed out again to the smallest later image that fits in it, and what that image leaves
+// over is freed for the next one. A page whose images have all been released is dropped, so swapping puzzle sheets
+// in and out doesn't grow the atlas.
+// Packing happens on the game thread, but pages only exist as textures on the main thread, which owns the renderer:
+// add() and replace() queue a copy of the pixels, and flushUploads() applies page changes and uploads in order
+// before a frame is drawn.
+class TextureAtlas
+{
+public:
+	static const int defaultPageSize = 2048;
+	static const int padding = 1; // Empty pixels kept around each image so filtering never samples a neighbour.
+
+	// Only reads the renderer's limits and formats; no texture is created until flushUploads().
+	TextureAtlas(SDL_Renderer *renderer, int pageSize = defaultPageSize);
+	~TextureAtlas();
+
+	TextureAtlas(const TextureAtlas &) = delete;
+	TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+	// Copies the surface into the atlas. The caller still owns the surface.
+	AtlasRegion add(SDL_Surface *surface);
+
+	// Uploads the surface over an existing region of the same size, e.g. to swap in a reloaded image.
+	// Returns false, leaving the region alone, if the sizes differ.
+	bool replace(const AtlasRegion &region, SDL_Surface *surface);
+
+	// Gives the region back for reuse. Its pixels stay on the page until something else is uploaded over them,
+	// or until the page is dropped because this was its last image.
+	void release(const AtlasRegion &region);
+
+	// Page slots, including dropped ones that a later page will take over.
+	int pageCount() const { return static_cast<int>(pages.size()); }
+
+	// Texture memory of the pages in use, whatever share of them holds images.
+	size_t textureBytes() const { return pageBytes; }
+
+	// Images on the page that haven't been released. The page is dropped once this reaches 0.
+	int pageImages(int page) const { return pages[page].images; }
+
+	// Renderer thread only: creates and destroys pages and uploads images as queued since the last call.
+	void flushUploads();
+
+	// Renderer thread only. NULL for a page that could not be created.
+	SDL_Texture *texture(int page) const { return page < static_cast<int>(textures.size()) ? textures[page].get() : NULL; }
+
+private:
+	struct atlasPage
+	{
+		int width = 0; // 0 for a dropped page.
+		int height = 0;
+		int shelfY = 0; // Top of the shelf currently being filled.
+		int shelfHeight = 0;
+		int cursorX = 0; // Next free x on the current shelf.
+		int images = 0; // Regions handed out and not released yet.
+	};
+
+	struct pendingUpload
+	{
+		int page;
+		SDL_Rect rect; // For a page change, only w and h count: the new page size, or 0 to destroy it.
+		SDL_Surface *pixels; // A private copy in pixelFormat, freed once uploaded. NULL for a page change.
+	};
+
+	bool upload(int page, const SDL_Rect &rect, SDL_Surface *surface);
+	bool reuse(int w, int h, AtlasRegion &region);
+	bool place(atlasPage &page, int w, int h, SDL_Rect &rect);
+	int addPage(int width, int height);
+	void dropPage(int pageI);
+	void queuePageChange(int pageI, int width, int height);
+	void setPage(int pageI, int width, int height);
+
+	SDL_Renderer *renderer;
+	int pageSize;
+	int maxTextureWidth = 0; // 0 if the renderer doesn't say.
+	int maxTextureHeight = 0;
+	Uint32 pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+	std::vector<atlasPage> pages; // Packing state, on the game thread.
+	std::vector<AtlasRegion> freeRegions;
+	size_t pageBytes = 0;
+
+	// Handed from the game thread to the renderer's thread.
+	std::mutex queueMutex;
+	std::vector<pendingUpload> uploads; // Page changes and image uploads, in the order they were made.
+
+	// Renderer thread side.
+	std::vector<std::unique_ptr<SDL_Texture, sdlDestructorTexture>> textures;
+	std::vector<pendingUpload> uploading;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// One bit per tile, packed 64 to a word.
+// Checking for any set bit and scanning cost a word at a time, so they stay cheap on boards with thousands of tiles.
+class TileMask
+{
+public:
+	void resize(int bits)
+	{
+		bitCount = bits;
+		words.assign((bits + 63) / 64, 0);
+	}
+
+	void clear() { std::fill(words.begin(), words.end(), 0); }
+	void setAll()
+	{
+		std::fill(words.begin(), words.end(), ~std::uint64_t(0));
+		if (bitCount % 64 != 0)
+		{
+			words.back() = (std::uint64_t(1) << (bitCount % 64)) - 1;
+		}
+	}
+
+	bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+	void set(int i) { words[i >> 6] |= std::uint64_t(1) << (i & 63); }
+	void reset(int i) { words[i >> 6] &= ~(std::uint64_t(1) << (i & 63)); }
+
+	bool any() const
+	{
+		for (std::uint64_t word : words)
+		{
+			if (word != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Calls fn(index) for every set bit in [begin, end), in ascending order. Only the words covering the range are read.
+	template <typename Func>
+	void forEachSetInRange(int begin, int end, Func fn) const
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+		const int lastWord = (end - 1) >> 6;
+		for (int w = begin >> 6; w <= lastWord; w++)
+		{
+			std::uint64_t word = words[w];
+			if (w == begin >> 6)
+			{
+				word &= ~std::uint64_t(0) << (begin & 63);
+			}
+			if (w == lastWord && (end & 63) != 0)
+			{
+				word &= (std::uint64_t(1) << (end & 63)) - 1;
+			}
+			scanWord(w, word, fn);
+		}
+	}
+
+private:
+	template <typename Func>
+	static void scanWord(int w, std::uint64_t word, Func &fn)
+	{
+		while (word != 0)
+		{
+			fn(w * 64 + lowestBit(word));
+			word &= word - 1;
+		}
+	}
+
+	static int lowestBit(std::uint64_t word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return static_cast<int>(index);
+#elif defined(__GNUC__)
+		return __builtin_ctzll(word);
+#else
+		int index = 0;
+		while ((word & 1) == 0)
+		{
+			word >>= 1;
+			index++;
+		}
+		return index;
+#endif
+	}
+
+	int bitCount = 0;
+	std::vector<std::uint64_t> words;
+};
@@ -0,0 +1,145 @@
+#include "pch.h"
+#include "Trace.h"
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct spanRecord
+	{
+		const char *name;
+		Uint64 begin;
+		Uint64 end;
+	};
+
+	// Only its own thread writes to a buffer; the lock is there so write() can read it while the thread carries on.
+	struct threadBuffer
+	{
+		std::mutex mutex;
+		std::vector<spanRecord> ring;
+		size_t recorded = 0; // Total spans ever recorded; the ring holds the last ringCapacity of them.
+		int threadId = 0;
+		std::string threadName;
+	};
+
+	std::atomic<bool> tracing{ false };
+	std::atomic<bool> dumpRequested{ false };
+	std::string tracePath;
+	Uint64 traceOrigin = 0;
+	double ticksPerUs = 1.0;
+
+	// Buffers are never freed, so spans from threads that have already exited still make it into the trace.
+	std::mutex registryMutex;
+	std::vector<std::unique_ptr<threadBuffer>> registry;
+	thread_local threadBuffer *localBuffer = nullptr;
+
+	threadBuffer &bufferForThisThread()
+	{
+		if (localBuffer == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(registryMutex);
+			registry.emplace_back(new threadBuffer);
+			localBuffer = registry.back().get();
+			localBuffer->threadId = static_cast<int>(registry.size());
+		}
+		return *localBuffer;
+	}
+
+	void onDumpSignal(int)
+	{
+		dumpRequested = true;
+	}
+}
+
+void Trace::start(const std::string &outputPath)
+{
+	tracePath = outputPath;
+	traceOrigin = SDL_GetPerformanceCounter();
+	ticksPerUs = SDL_GetPerformanceFrequency() / 1000000.0;
+#if !defined(_WIN32)
+	std::signal(SIGUSR1, onDumpSignal);
+#endif
+	tracing.store(true, std::memory_order_release);
+}
+
+bool Trace::enabled()
+{
+	return tracing.load(std::memory_order_relaxed);
+}
+
+void Trace::nameThread(const char *name)
+{
+	threadBuffer &buffer = bufferForThisThread();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.threadName = name;
+}
+
+void Trace::record(const char *name, Uint64 begin, Uint64 end)
+{
+	threadBuffer &buffer = bufferForThisThread();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	if (buffer.ring.empty())
+	{
+		buffer.ring.resize(ringCapacity);
+	}
+	buffer.ring[buffer.recorded % ringCapacity] = { name, begin, end };
+	buffer.recorded++;
+}
+
+bool Trace::write()
+{
+	if (!enabled())
+	{
+		return false;
+	}
+
+	std::ofstream out(tracePath, std::ios::trunc);
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	out << "{\"traceEvents\":[\n";
+	bool first = true;
+	size_t spanCount = 0;
+
+	std::lock_guard<std::mutex> registryLock(registryMutex);
+	for (const auto &buffer : registry)
+	{
+		std::lock_guard<std::mutex> lock(buffer->mutex);
+		if (!buffer->threadName.empty())
+		{
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+			first = false;
+		}
+
+		const size_t kept = buffer->recorded < static_cast<size_t>(ringCapacity) ? buffer->recorded : ringCapacity;
+		for (size_t spanI = buffer->recorded - kept; spanI < buffer->recorded; spanI++)
+		{
+			const spanRecord &span = buffer->ring[spanI % ringCapacity];
+			out << (first ? "" : ",\n") << "{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << (span.begin - traceOrigin) / ticksPerUs << ",\"dur\":" << (span.end - span.begin) / ticksPerUs << "}";
+			first = false;
+		}
+		spanCount += kept;
+	}
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	if (!out)
+	{
+		SDL_Log("Trace: could not write %s", tracePath.c_str());
+		return false;
+	}
+	SDL_Log("Trace: wrote %u spans to %s", static_cast<unsigned>(spanCount), tracePath.c_str());
+	return true;
+}
+
+void Trace::pollDumpRequest()
+{
+	if (dumpRequested.exchange(false))
+	{
+		write();
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+
+// Records named spans of time into one ring buffer per thread and writes them out as Chrome trace JSON,
+// which chrome://tracing and Perfetto open directly. Nothing is recorded until start() is called, and a
+// span then costs two performance counter reads and an uncontended lock on its own thread's buffer.
+// Each thread keeps its last ringCapacity spans, so a long session can be traced without growing memory.
+class Trace
+{
+public:
+	static const int ringCapacity = 32768; // Spans kept per thread.
+
+	// Starts recording. write() and requested dumps go to outputPath.
+	// On POSIX systems SIGUSR1 asks for a dump, which the main loop picks up through pollDumpRequest().
+	static void start(const std::string &outputPath);
+	static bool enabled();
+
+	// Names the calling thread in the trace viewer.
+	static void nameThread(const char *name);
+
+	static void record(const char *name, Uint64 begin, Uint64 end);
+
+	// Writes every span still held in the ring buffers. Returns false if the file could not be written.
+	static bool write();
+
+	// Writes the trace if a dump was asked for since the last call. Call from the main loop.
+	static void pollDumpRequest();
+};
+
+// Records the time from construction to destruction as a span. name must outlive the trace, e.g. a string literal.
+class TraceSpan
+{
+public:
+	explicit TraceSpan(const char *name)
+		: name(name), begin(Trace::enabled() ? SDL_GetPerformanceCounter() : 0)
+	{
+	}
+
+	~TraceSpan()
+	{
+		if (begin != 0)
+		{
+			Trace::record(name, begin, SDL_GetPerformanceCounter());
+		}
+	}
+
+	TraceSpan(const TraceSpan &) = delete;
+	TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+	const char *name;
+	Uint64 begin;
+};